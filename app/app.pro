@@ -0,0 +1,81 @@
+QT       += core gui widgets opengl openglwidgets network
+
+CONFIG += c++20
+
+TARGET = QOpenGLWidget_example
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+INCLUDEPATH += \
+    $$PWD/../include
+
+SOURCES += \
+    ../src/BatchRenderer.cpp \
+    ../src/CollisionWorld.cpp \
+    ../src/Cube.cpp \
+    ../src/FrameTimer.cpp \
+    ../src/Frustum.cpp \
+    ../src/GLStateCache.cpp \
+    ../src/ImageWriteQueue.cpp \
+    ../src/LoadGenerator.cpp \
+    ../src/Material.cpp \
+    ../src/Mesh.cpp \
+    ../src/Obb.cpp \
+    ../src/RayMath.cpp \
+    ../src/RenderQueue.cpp \
+    ../src/RenderResources.cpp \
+    ../src/ResolutionScaler.cpp \
+    ../src/SceneCommandServer.cpp \
+    ../src/SceneManager.cpp \
+    ../src/SceneModel.cpp \
+    ../src/SceneProtocol.cpp \
+    ../src/SceneRenderer.cpp \
+    ../src/StaticBatcher.cpp \
+    ../src/TextureDecoder.cpp \
+    ../src/TextureImage.cpp \
+    ../src/TextureStreamer.cpp \
+    ../src/main.cpp \
+    ../src/MainWindow.cpp \
+
+HEADERS += \
+    ../include/BatchRenderer.h \
+    ../include/CollisionWorld.h \
+    ../include/Cube.h \
+    ../include/FrameTimer.h \
+    ../include/Frustum.h \
+    ../include/GLStateCache.h \
+    ../include/ImageWriteQueue.h \
+    ../include/LoadGenerator.h \
+    ../include/Material.h \
+    ../include/Mesh.h \
+    ../include/Obb.h \
+    ../include/RayMath.h \
+    ../include/RenderQueue.h \
+    ../include/RenderResources.h \
+    ../include/ResolutionScaler.h \
+    ../include/Shape.h \
+    ../include/SceneCommandServer.h \
+    ../include/SceneManager.h \
+    ../include/SceneModel.h \
+    ../include/SceneProtocol.h \
+    ../include/SceneRenderer.h \
+    ../include/SpscQueue.h \
+    ../include/StaticBatcher.h \
+    ../include/TextureDecoder.h \
+    ../include/TextureImage.h \
+    ../include/TextureStreamer.h \
+    ../include/MainWindow.h
+
+FORMS += \
+    ../ui/SceneManager.ui \
+    ../ui/MainWindow.ui
+
+RESOURCES += \
+    ../resources/shaders.qrc
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,611 @@
+#include "MathBenchmark.h"
+#include "CollisionWorld.h"
+#include "Cube.h"
+#include "RayMath.h"
+#include "SceneModel.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQuaternion>
+#include <QSysInfo>
+#include <QVector4D>
+#include <QDebug>
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+// Inputs are cycled through a table, so the compiler can't fold the work away and the data stays in cache
+static const int s_tableSize = 1024;
+
+// Results are summed into this, otherwise the optimizer may drop the measured calls
+static volatile float s_sink = 0.0f;
+
+struct TestCamera {
+    QMatrix4x4 Projection;
+    QMatrix4x4 View;
+    float Width;
+    float Height;
+};
+
+MathBenchmark::MathBenchmark(const BenchOptions &options) :
+    m_options(options),
+    m_random(options.Seed),
+    m_failures(0)
+{
+}
+
+bool MathBenchmark::run()
+{
+    checkScreenRays();
+    checkCubeIntersections();
+    checkCameraBasis();
+    checkPicking();
+    checkObbIntersections();
+    checkCollisionPairs();
+
+    benchmarkRays();
+    benchmarkCamera();
+    benchmarkShapes();
+    benchmarkCollisions();
+
+    const bool written = writeReport();
+    if (m_failures > 0) {
+        qInfo() << "MathBenchmark:" << m_failures << "property failures";
+    }
+    return written && m_failures == 0;
+}
+
+template <typename Operation>
+void MathBenchmark::measure(const QString &name, Operation operation)
+{
+    // Double the iterations until one batch takes long enough for the timer to be meaningful
+    const qint64 minNs = qint64(m_options.MinTimeMs) * 1000000;
+    QElapsedTimer timer;
+    float sink = 0.0f;
+    qint64 iterations = 1;
+    for (;;) {
+        timer.start();
+        for (qint64 i = 0; i < iterations; i++) {
+            sink += operation(int(i % s_tableSize));
+        }
+        if (timer.nsecsElapsed() >= minNs || iterations >= (qint64(1) << 32))
+            break;
+        iterations *= 2;
+    }
+
+    double best = std::numeric_limits<double>::max();
+    for (int repetition = 0; repetition < m_options.Repetitions; repetition++) {
+        timer.start();
+        for (qint64 i = 0; i < iterations; i++) {
+            sink += operation(int(i % s_tableSize));
+        }
+        best = qMin(best, double(timer.nsecsElapsed()) / iterations);
+    }
+    s_sink = s_sink + sink;
+    addTiming(name, iterations, best);
+}
+
+void MathBenchmark::addTiming(const QString &name, qint64 iterations, double nsPerOp)
+{
+    QJsonObject result;
+    result["name"] = name;
+    result["iterations"] = iterations;
+    result["ns_per_op"] = nsPerOp;
+    m_benchmarks.append(result);
+    qInfo().noquote() << QString("%1 %2 ns").arg(name, -28).arg(nsPerOp, 0, 'f', 2);
+}
+
+void MathBenchmark::addProperty(const QString &name, int cases, int skipped, int failures)
+{
+    QJsonObject result;
+    result["name"] = name;
+    result["cases"] = cases;
+    result["skipped"] = skipped;
+    result["failures"] = failures;
+    m_properties.append(result);
+    m_failures += failures;
+    qInfo().noquote() << QString("%1 %2 cases, %3 skipped, %4 failed").arg(name, -28).arg(cases).arg(skipped).arg(failures);
+}
+
+float MathBenchmark::uniform(float low, float high)
+{
+    return low + float(m_random.generateDouble()) * (high - low);
+}
+
+static QVector3D randomVector(QRandomGenerator &random, float extent)
+{
+    return QVector3D(float(random.bounded(2.0 * extent) - extent), float(random.bounded(2.0 * extent) - extent),
+                     float(random.bounded(2.0 * extent) - extent));
+}
+
+// Uniformly distributed rotation, from a normalized 4D gaussian
+static QQuaternion randomRotation(QRandomGenerator &random)
+{
+    std::normal_distribution<float> normal;
+    QQuaternion rotation;
+    do {
+        rotation = QQuaternion(normal(random), normal(random), normal(random), normal(random));
+    } while (rotation.length() < 0.001f);
+    return rotation.normalized();
+}
+
+static QMatrix4x4 randomRigidTransformation(QRandomGenerator &random, float extent)
+{
+    QMatrix4x4 transformation;
+    transformation.translate(randomVector(random, extent));
+    transformation.rotate(randomRotation(random));
+    return transformation;
+}
+
+// Perspective or orthographic camera like the views use, looking at a point near the origin
+static TestCamera randomCamera(QRandomGenerator &random)
+{
+    TestCamera camera;
+    camera.Width = float(random.bounded(64, 4096));
+    camera.Height = float(random.bounded(64, 4096));
+    const float aspect = camera.Width / camera.Height;
+    if (random.bounded(2) == 0) {
+        camera.Projection.perspective(float(10.0 + random.bounded(110.0)), aspect, 2.0f, 200.0f);
+    } else {
+        const float halfHeight = float(1.0 + random.bounded(100.0));
+        camera.Projection.ortho(-halfHeight * aspect, halfHeight * aspect, -halfHeight, halfHeight, 2.0f, 200.0f);
+    }
+
+    QVector3D position;
+    do {
+        position = randomVector(random, 100.0f);
+    } while (position.length() < 5.0f);
+    camera.View = RayMath::cameraBasisReference(position, randomVector(random, 2.0f), QVector3D(0.0f, 1.0f, 0.0f)).View;
+    return camera;
+}
+
+// Box with a random orientation and size, as a shape's transformation would give it
+static Obb randomObb(QRandomGenerator &random, float extent)
+{
+    QMatrix4x4 transformation = randomRigidTransformation(random, extent);
+    transformation.scale(float(0.2 + random.bounded(1.8)), float(0.2 + random.bounded(1.8)), float(0.2 + random.bounded(1.8)));
+    return Obb::fromTransformation(transformation);
+}
+
+static Obb scaledObb(const Obb &box, float factor)
+{
+    Obb scaled = box;
+    scaled.HalfExtents *= factor;
+    return scaled;
+}
+
+static bool fuzzyEqual(const QVector3D &a, const QVector3D &b, float tolerance)
+{
+    return (a - b).length() <= tolerance;
+}
+
+void MathBenchmark::checkScreenRays()
+{
+    // The combined inverse and the two separate ones differ only by rounding
+    int failures = 0;
+    for (int i = 0; i < m_options.Cases; i++) {
+        const TestCamera camera = randomCamera(m_random);
+        const float x = uniform(0.0f, camera.Width);
+        const float y = uniform(0.0f, camera.Height);
+        const RayMath::Ray fast = RayMath::screenRay(x, y, camera.Width, camera.Height, (camera.Projection * camera.View).inverted());
+        const RayMath::Ray reference = RayMath::screenRayReference(x, y, camera.Width, camera.Height, camera.Projection, camera.View);
+        if (!fuzzyEqual(fast.Origin, reference.Origin, 1e-3f * (1.0f + reference.Origin.length())) ||
+            !fuzzyEqual(fast.Direction, reference.Direction, 1e-3f)) {
+            if (failures == 0) {
+                qInfo() << "screen_ray mismatch at" << x << y << ":" << fast.Origin << fast.Direction << "vs" << reference.Origin
+                        << reference.Direction;
+            }
+            failures++;
+        }
+    }
+    addProperty("screen_ray", m_options.Cases, 0, failures);
+}
+
+void MathBenchmark::checkCubeIntersections()
+{
+    int skipped = 0;
+    int failures = 0;
+    for (int i = 0; i < m_options.Cases; i++) {
+        const QMatrix4x4 transformation = randomRigidTransformation(m_random, 20.0f);
+        // Aim at the area around the cube so about half of the rays hit
+        const QVector3D target = transformation.map(randomVector(m_random, 1.6f));
+        RayMath::Ray ray;
+        ray.Origin = randomVector(m_random, 40.0f);
+        ray.Direction = (target - ray.Origin).normalized();
+        if (ray.Direction.isNull()) {
+            skipped++;
+            continue;
+        }
+
+        double tNear = 0.0;
+        double tFar = 0.0;
+        const bool expected = RayMath::intersectsCubeReference(ray, transformation, &tNear, &tFar);
+        // Rays grazing an edge, starting on the surface or running within the fast path's parallel tolerance
+        // may go either way in float
+        bool ambiguous = std::fabs(tFar - tNear) < 1e-3 || std::fabs(tFar) < 1e-3;
+        for (int axis = 0; axis < 3; axis++) {
+            ambiguous = ambiguous || std::fabs(QVector3D::dotProduct(transformation.column(axis).toVector3D(), ray.Direction)) < 0.002f;
+        }
+        if (ambiguous) {
+            skipped++;
+            continue;
+        }
+
+        if (RayMath::intersectsCube(ray, transformation) != expected) {
+            if (failures == 0) {
+                qInfo() << "cube_intersection mismatch: ray" << ray.Origin << ray.Direction << "expected" << expected;
+            }
+            failures++;
+        }
+    }
+    addProperty("cube_intersection", m_options.Cases, skipped, failures);
+}
+
+void MathBenchmark::checkCameraBasis()
+{
+    int skipped = 0;
+    int failures = 0;
+    for (int i = 0; i < m_options.Cases; i++) {
+        const QVector3D position = randomVector(m_random, 100.0f);
+        const QVector3D lookAt = randomVector(m_random, 10.0f);
+        const QVector3D worldUp = randomVector(m_random, 1.0f).normalized();
+        const QVector3D back = (position - lookAt).normalized();
+        // Looking along the up direction leaves the roll undefined
+        if (back.isNull() || QVector3D::crossProduct(worldUp, back).length() < 0.05f) {
+            skipped++;
+            continue;
+        }
+
+        const RayMath::CameraBasis fast = RayMath::cameraBasis(position, lookAt, worldUp);
+        const RayMath::CameraBasis reference = RayMath::cameraBasisReference(position, lookAt, worldUp);
+        bool equal = fuzzyEqual(fast.Right, reference.Right, 1e-5f) && fuzzyEqual(fast.Up, reference.Up, 1e-5f);
+        const float tolerance = 1e-4f * (1.0f + position.length());
+        for (int element = 0; element < 16; element++) {
+            equal = equal && std::fabs(fast.View.constData()[element] - reference.View.constData()[element]) <= tolerance;
+        }
+        if (!equal) {
+            if (failures == 0) {
+                qInfo() << "camera_basis mismatch at" << position << lookAt << worldUp;
+            }
+            failures++;
+        }
+    }
+    addProperty("camera_basis", m_options.Cases, skipped, failures);
+}
+
+void MathBenchmark::checkPicking()
+{
+    // A ray through the projected center of a visible cube always hits it
+    int skipped = 0;
+    int failures = 0;
+    for (int i = 0; i < m_options.Cases; i++) {
+        const TestCamera camera = randomCamera(m_random);
+        const QMatrix4x4 transformation = randomRigidTransformation(m_random, 20.0f);
+        const QVector4D clip = camera.Projection * camera.View * QVector4D(transformation.column(3).toVector3D(), 1.0f);
+        if (clip.w() <= 0.0f) {
+            skipped++;
+            continue;
+        }
+        const QVector3D ndc = clip.toVector3DAffine();
+        if (std::fabs(ndc.x()) > 1.0f || std::fabs(ndc.y()) > 1.0f || std::fabs(ndc.z()) > 1.0f) {
+            skipped++;
+            continue;
+        }
+
+        const float x = (ndc.x() * 0.5f + 0.5f) * camera.Width;
+        const float y = (ndc.y() * 0.5f + 0.5f) * camera.Height;
+        const RayMath::Ray ray = RayMath::screenRay(x, y, camera.Width, camera.Height, (camera.Projection * camera.View).inverted());
+        if (!RayMath::intersectsCube(ray, transformation)) {
+            if (failures == 0) {
+                qInfo() << "picking missed the cube at" << transformation.column(3).toVector3D() << "through" << x << y;
+            }
+            failures++;
+        }
+    }
+    addProperty("picking", m_options.Cases, skipped, failures);
+}
+
+void MathBenchmark::checkObbIntersections()
+{
+    // No exact reference for the separating axis test, but it is symmetric, implies overlapping bounds,
+    // and spheres inscribed in and around the boxes settle the clear cases
+    int skipped = 0;
+    int failures = 0;
+    for (int i = 0; i < m_options.Cases; i++) {
+        const Obb a = randomObb(m_random, 3.0f);
+        const Obb b = randomObb(m_random, 3.0f);
+        const bool overlap = a.intersects(b);
+        // Boxes that barely touch may go either way in float
+        if (scaledObb(a, 0.999f).intersects(scaledObb(b, 0.999f)) != scaledObb(a, 1.001f).intersects(scaledObb(b, 1.001f))) {
+            skipped++;
+            continue;
+        }
+
+        QVector3D minA;
+        QVector3D maxA;
+        QVector3D minB;
+        QVector3D maxB;
+        a.bounds(minA, maxA);
+        b.bounds(minB, maxB);
+        bool boundsOverlap = true;
+        for (int axis = 0; axis < 3; axis++) {
+            boundsOverlap = boundsOverlap && minA[axis] <= maxB[axis] && minB[axis] <= maxA[axis];
+        }
+        const float distance = (a.Center - b.Center).length();
+        const float inner = qMin(qMin(a.HalfExtents.x(), a.HalfExtents.y()), a.HalfExtents.z()) +
+                            qMin(qMin(b.HalfExtents.x(), b.HalfExtents.y()), b.HalfExtents.z());
+        const float outer = a.HalfExtents.length() + b.HalfExtents.length();
+
+        if (overlap != b.intersects(a) || (overlap && !boundsOverlap) || (distance < inner && !overlap) || (distance > outer && overlap)) {
+            if (failures == 0) {
+                qInfo() << "obb_sat inconsistent for boxes at" << a.Center << b.Center << ":" << overlap;
+            }
+            failures++;
+        }
+    }
+    addProperty("obb_sat", m_options.Cases, skipped, failures);
+}
+
+void MathBenchmark::checkCollisionPairs()
+{
+    // Worlds edited at random must report the same pairs and query hits as testing every box against every other.
+    // The small columns make boxes span and cross several of them.
+    const int worlds = qMax(1, m_options.Cases / 1000);
+    const int boxCount = 500;
+    int failures = 0;
+    for (int world = 0; world < worlds; world++) {
+        CollisionWorld collisions(4.0f);
+        std::vector<Obb> boxes;
+        std::vector<CollisionWorld::ProxyId> proxies;
+        std::vector<bool> alive;
+        for (int i = 0; i < boxCount; i++) {
+            boxes.push_back(randomObb(m_random, 15.0f));
+            proxies.push_back(collisions.add(boxes.back()));
+            alive.push_back(true);
+        }
+        for (int edit = 0; edit < boxCount * 2; edit++) {
+            const int i = m_random.bounded(boxCount);
+            const int operation = m_random.bounded(4);
+            if (!alive[i]) {
+                boxes[i] = randomObb(m_random, 15.0f);
+                proxies[i] = collisions.add(boxes[i]);
+                alive[i] = true;
+            } else if (operation == 0) {
+                collisions.remove(proxies[i]);
+                alive[i] = false;
+            } else if (operation == 1) {
+                boxes[i] = randomObb(m_random, 15.0f);
+                collisions.update(proxies[i], boxes[i]);
+            } else {
+                boxes[i].Center += randomVector(m_random, 0.5f);
+                collisions.update(proxies[i], boxes[i]);
+            }
+        }
+
+        std::set<std::pair<CollisionWorld::ProxyId, CollisionWorld::ProxyId>> expected;
+        for (int i = 0; i < boxCount; i++) {
+            for (int j = i + 1; j < boxCount; j++) {
+                if (alive[i] && alive[j] && boxes[i].intersects(boxes[j])) {
+                    expected.insert({ qMin(proxies[i], proxies[j]), qMax(proxies[i], proxies[j]) });
+                }
+            }
+        }
+        std::vector<std::pair<CollisionWorld::ProxyId, CollisionWorld::ProxyId>> pairs;
+        collisions.overlappingPairs(pairs);
+        bool equal = pairs.size() == expected.size() && std::set(pairs.begin(), pairs.end()) == expected;
+
+        for (int query = 0; query < 16; query++) {
+            const Obb box = randomObb(m_random, 15.0f);
+            size_t hits = 0;
+            for (int i = 0; i < boxCount; i++) {
+                hits += alive[i] && box.intersects(boxes[i]);
+            }
+            std::vector<CollisionWorld::ProxyId> found;
+            collisions.query(box, found);
+            equal = equal && found.size() == hits && collisions.overlapsAny(box) == (hits > 0);
+        }
+
+        if (!equal) {
+            if (failures == 0) {
+                qInfo() << "sap_pairs found" << pairs.size() << "pairs, expected" << expected.size();
+            }
+            failures++;
+        }
+    }
+    addProperty("sap_pairs", worlds, 0, failures);
+}
+
+void MathBenchmark::benchmarkRays()
+{
+    std::vector<TestCamera> cameras;
+    std::vector<QMatrix4x4> inverses;
+    std::vector<QVector3D> pixels;
+    std::vector<RayMath::Ray> rays;
+    std::vector<QMatrix4x4> transformations;
+    for (int i = 0; i < s_tableSize; i++) {
+        cameras.push_back(randomCamera(m_random));
+        inverses.push_back((cameras.back().Projection * cameras.back().View).inverted());
+        pixels.push_back(QVector3D(uniform(0.0f, cameras.back().Width), uniform(0.0f, cameras.back().Height), 0.0f));
+        transformations.push_back(randomRigidTransformation(m_random, 20.0f));
+        RayMath::Ray ray;
+        ray.Origin = randomVector(m_random, 40.0f);
+        ray.Direction = (transformations.back().map(randomVector(m_random, 1.6f)) - ray.Origin).normalized();
+        rays.push_back(ray);
+    }
+
+    measure("ray.screen_reference", [&](int i) {
+        const TestCamera &camera = cameras[i];
+        return RayMath::screenRayReference(pixels[i].x(), pixels[i].y(), camera.Width, camera.Height, camera.Projection, camera.View)
+            .Direction.x();
+    });
+    measure("ray.screen", [&](int i) {
+        const TestCamera &camera = cameras[i];
+        return RayMath::screenRay(pixels[i].x(), pixels[i].y(), camera.Width, camera.Height, inverses[i]).Direction.x();
+    });
+    // Paid once per camera change by the fast path
+    measure("ray.screen_setup", [&](int i) { return (cameras[i].Projection * cameras[i].View).inverted().constData()[0]; });
+    measure("ray.cube_reference", [&](int i) { return float(RayMath::intersectsCubeReference(rays[i], transformations[i])); });
+    measure("ray.cube", [&](int i) { return float(RayMath::intersectsCube(rays[i], transformations[i])); });
+
+    // What a click costs: one ray against every shape of a scene
+    SceneModel model;
+    model.createCubes(1000);
+    measure("ray.pick_1000_shapes", [&](int i) {
+        const TestCamera &camera = cameras[i];
+        const RayMath::Ray ray = RayMath::screenRay(pixels[i].x(), pixels[i].y(), camera.Width, camera.Height, inverses[i]);
+        int hits = 0;
+        for (const auto &shape : model.shapes()) {
+            hits += RayMath::intersectsCube(ray, shape.second->getTransformation());
+        }
+        return float(hits);
+    });
+}
+
+void MathBenchmark::benchmarkCamera()
+{
+    std::vector<QVector3D> positions;
+    std::vector<QVector3D> targets;
+    for (int i = 0; i < s_tableSize; i++) {
+        positions.push_back(randomVector(m_random, 100.0f));
+        targets.push_back(randomVector(m_random, 2.0f));
+    }
+    const QVector3D worldUp(0.0f, 1.0f, 0.0f);
+
+    measure("camera.basis_reference",
+            [&](int i) { return RayMath::cameraBasisReference(positions[i], targets[i], worldUp).View.constData()[12]; });
+    measure("camera.basis", [&](int i) { return RayMath::cameraBasis(positions[i], targets[i], worldUp).View.constData()[12]; });
+    measure("camera.perspective", [&](int i) {
+        QMatrix4x4 projection;
+        projection.perspective(30.0f + (i & 15), 1.5f, 2.0f, 200.0f);
+        return projection.constData()[0];
+    });
+}
+
+void MathBenchmark::benchmarkShapes()
+{
+    measure("shape.create_cube", [](int) {
+        Cube cube(QStringLiteral("bench"));
+        return cube.getTransformation().constData()[12];
+    });
+    measure("shape.create_1000_cubes", [](int) {
+        SceneModel model;
+        model.createCubes(1000);
+        return float(model.shapes().size());
+    });
+}
+
+void MathBenchmark::benchmarkCollisions()
+{
+    // Cubes filling about a sixteenth of the space, so most touch none or a few others. Building is timed once.
+    const int count = m_options.CollisionShapes;
+    const float extent = 2.5f * std::cbrt(float(count));
+    std::vector<Obb> boxes;
+    boxes.reserve(count);
+    for (int i = 0; i < count; i++) {
+        boxes.push_back(Obb::fromTransformation(randomRigidTransformation(m_random, extent)));
+    }
+
+    CollisionWorld collisions;
+    std::vector<CollisionWorld::ProxyId> proxies;
+    proxies.reserve(count);
+    QElapsedTimer timer;
+    timer.start();
+    for (const Obb &box : boxes) {
+        proxies.push_back(collisions.add(box));
+    }
+    addTiming(QString("collision.insert_%1").arg(count), count, double(timer.nsecsElapsed()) / qMax(count, 1));
+
+    std::vector<std::pair<CollisionWorld::ProxyId, CollisionWorld::ProxyId>> pairs;
+    timer.start();
+    collisions.overlappingPairs(pairs);
+    addTiming(QString("collision.pairs_%1").arg(count), 1, double(timer.nsecsElapsed()));
+
+    if (count == 0)
+        return;
+
+    // Shapes jittering in place, what a frame of streamed transforms costs per shape
+    std::vector<QVector3D> offsets;
+    std::vector<QVector3D> queries;
+    for (int i = 0; i < s_tableSize; i++) {
+        offsets.push_back(randomVector(m_random, 0.05f));
+        queries.push_back(randomVector(m_random, extent));
+    }
+    measure("collision.update_small_move", [&](int i) {
+        const int index = (i * 977) % count;
+        boxes[index].Center += offsets[i];
+        collisions.update(proxies[index], boxes[index]);
+        return boxes[index].Center.x();
+    });
+    measure("collision.overlaps_any", [&](int i) {
+        Obb box = boxes[i % count];
+        box.Center = queries[i];
+        return float(collisions.overlapsAny(box));
+    });
+
+    // The sweep against testing every pair, on a world of the same density small enough for the latter
+    const int smallCount = qMin(count, 4096);
+    const float smallExtent = 2.5f * std::cbrt(float(smallCount));
+    std::vector<Obb> smallBoxes;
+    CollisionWorld small;
+    for (int i = 0; i < smallCount; i++) {
+        smallBoxes.push_back(Obb::fromTransformation(randomRigidTransformation(m_random, smallExtent)));
+        small.add(smallBoxes.back());
+    }
+    measure(QString("collision.pairs_%1").arg(smallCount), [&](int) {
+        pairs.clear();
+        small.overlappingPairs(pairs);
+        return float(pairs.size());
+    });
+    measure(QString("collision.pairs_%1_brute_force").arg(smallCount), [&](int) {
+        int found = 0;
+        for (int i = 0; i < smallCount; i++) {
+            for (int j = i + 1; j < smallCount; j++) {
+                found += smallBoxes[i].intersects(smallBoxes[j]);
+            }
+        }
+        return float(found);
+    });
+}
+
+bool MathBenchmark::writeReport()
+{
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    context["qt_version"] = QString(qVersion());
+    context["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+    context["seed"] = qint64(m_options.Seed);
+    context["cases"] = m_options.Cases;
+    context["min_time_ms"] = m_options.MinTimeMs;
+    context["repetitions"] = m_options.Repetitions;
+#ifdef QT_DEBUG
+    context["build"] = "debug";
+#else
+    context["build"] = "release";
+#endif
+
+    QJsonObject report;
+    report["context"] = context;
+    report["benchmarks"] = m_benchmarks;
+    report["properties"] = m_properties;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (m_options.OutputPath.isEmpty()) {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+        std::fflush(stdout);
+        return true;
+    }
+
+    QFile file(m_options.OutputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        qDebug() << "MathBenchmark::writeReport: Failed to write" << m_options.OutputPath << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef MATHBENCHMARK_H
+#define MATHBENCHMARK_H
+
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QString>
+
+struct BenchOptions {
+    // File the JSON report goes to, stdout if empty
+    QString OutputPath;
+    quint32 Seed = 1;
+    // Random inputs per property check
+    int Cases = 100000;
+    // Each repetition of a benchmark runs at least this long
+    int MinTimeMs = 100;
+    int Repetitions = 5;
+    // Shapes in the world the collision benchmarks run on
+    int CollisionShapes = 1000000;
+};
+
+// Times the math hot paths against their reference implementations and checks on random input that both agree.
+// Needs no display or GL context. The report is JSON, so runs can be compared over time:
+//   { "context": {...}, "benchmarks": [ { "name", "iterations", "ns_per_op" } ],
+//     "properties": [ { "name", "cases", "skipped", "failures" } ] }
+// Benchmarks keep the fastest repetition, the least disturbed one.
+class MathBenchmark
+{
+public:
+    explicit MathBenchmark(const BenchOptions &options);
+
+    // Returns false if a property check failed or the report could not be written
+    bool run();
+
+private:
+    BenchOptions m_options;
+    QRandomGenerator m_random;
+    QJsonArray m_benchmarks;
+    QJsonArray m_properties;
+    int m_failures;
+
+    template <typename Operation>
+    void measure(const QString &name, Operation operation);
+    void addTiming(const QString &name, qint64 iterations, double nsPerOp);
+    void addProperty(const QString &name, int cases, int skipped, int failures);
+    float uniform(float low, float high);
+
+    void benchmarkRays();
+    void benchmarkCamera();
+    void benchmarkShapes();
+    void benchmarkCollisions();
+    void checkScreenRays();
+    void checkCubeIntersections();
+    void checkCameraBasis();
+    void checkPicking();
+    void checkObbIntersections();
+    void checkCollisionPairs();
+    bool writeReport();
+};
+
+#endif    // MATHBENCHMARK_H
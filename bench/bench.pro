@@ -0,0 +1,34 @@
+QT       += core gui opengl
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+TARGET = math_bench
+
+INCLUDEPATH += \
+    $$PWD \
+    $$PWD/../include
+
+SOURCES += \
+    ../src/CollisionWorld.cpp \
+    ../src/Cube.cpp \
+    ../src/Material.cpp \
+    ../src/Mesh.cpp \
+    ../src/Obb.cpp \
+    ../src/RayMath.cpp \
+    ../src/SceneModel.cpp \
+    ../src/StaticBatcher.cpp \
+    MathBenchmark.cpp \
+    main.cpp
+
+HEADERS += \
+    ../include/CollisionWorld.h \
+    ../include/Cube.h \
+    ../include/Material.h \
+    ../include/Mesh.h \
+    ../include/Obb.h \
+    ../include/RayMath.h \
+    ../include/SceneModel.h \
+    ../include/Shape.h \
+    ../include/StaticBatcher.h \
+    MathBenchmark.h
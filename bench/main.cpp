@@ -0,0 +1,37 @@
+#include "MathBenchmark.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+// Times the math hot paths, checks them against their references and prints a JSON report
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks and property checks of the picking, camera and collision math, no display needed.\n"
+                                     "The exit code is 1 if a check failed.");
+    parser.addHelpOption();
+    const QCommandLineOption outputOption("output", "Write the JSON report to <file> instead of stdout.", "file");
+    const QCommandLineOption seedOption("seed", "Seed of the random inputs.", "number", "1");
+    const QCommandLineOption casesOption("cases", "Random inputs per property check.", "count", "100000");
+    const QCommandLineOption minTimeOption("min-time", "Shortest repetition of a benchmark.", "ms", "100");
+    const QCommandLineOption repetitionsOption("repetitions", "Repetitions per benchmark, the fastest is reported.", "count", "5");
+    const QCommandLineOption collisionShapesOption("collision-shapes", "Shapes in the collision benchmark world.", "count", "1000000");
+    parser.addOptions({ outputOption, seedOption, casesOption, minTimeOption, repetitionsOption, collisionShapesOption });
+    parser.process(a);
+
+    BenchOptions options;
+    options.OutputPath = parser.value(outputOption);
+    options.Seed = parser.value(seedOption).toUInt();
+    options.Cases = parser.value(casesOption).toInt();
+    options.MinTimeMs = parser.value(minTimeOption).toInt();
+    options.Repetitions = parser.value(repetitionsOption).toInt();
+    options.CollisionShapes = parser.value(collisionShapesOption).toInt();
+    if (options.Cases < 0 || options.MinTimeMs < 1 || options.Repetitions < 1 || options.CollisionShapes < 0) {
+        parser.showHelp(1);
+    }
+
+    MathBenchmark benchmark(options);
+    return benchmark.run() ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include <QSize>
+#include <QString>
+
+#include <atomic>
+
+class ImageWriteQueue;
+class QOffscreenSurface;
+class QOpenGLContext;
+
+struct BatchOptions {
+    QString OutputDir;
+    int SceneCount = 16;
+    int ShapesPerScene = 100;
+    QSize ImageSize { 1920, 1080 };
+    // Edge length of the render target, 0 for the largest the driver supports
+    int TileSize = 0;
+    int Threads = 1;
+    // Merge each scene into static chunks, pays off once a scene is drawn as many tiles
+    bool StaticBatching = false;
+};
+
+// Renders generated scenes to PNG files without any window.
+// Every worker thread has its own offscreen context and renderer and claims scenes from a shared counter,
+// images larger than the maximum framebuffer size are put together from tiles.
+// Finished images go to an ImageWriteQueue, so encoding overlaps with rendering.
+class BatchRenderer
+{
+public:
+    explicit BatchRenderer(const BatchOptions &options);
+
+    // Must be called on the GUI thread, returns once every image is written
+    bool run();
+
+private:
+    struct Worker {
+        QOffscreenSurface *Surface = nullptr;
+        QOpenGLContext *Context = nullptr;
+    };
+
+    BatchOptions m_options;
+    std::atomic<int> m_nextScene;
+    std::atomic<int> m_rendered;
+
+    void renderScenes(Worker worker, ImageWriteQueue &writer);
+};
+
+#endif    // BATCHRENDERER_H
@@ -0,0 +1,104 @@
+#ifndef COLLISIONWORLD_H
+#define COLLISIONWORLD_H
+
+#include "Obb.h"
+
+#include <QVector3D>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Shape;
+
+// Broad phase over oriented boxes, sweep-and-prune on the x axis with an exact OBB test as narrow phase.
+//
+// A single sorted axis degrades as the world grows: the slab a box spans along x holds a fixed share of all shapes.
+// Space is therefore cut into columns along y and z, each with its own sweep over x, and a box is listed in every
+// column its bounds touch. A pair or query hit found in several columns is only reported in the one holding the
+// lower corner of the overlap, so nothing comes out twice.
+//
+// Each column keeps its entries sorted by the lower x bound of the box. A query starts its scan that far left of its
+// own lower bound which the column's widest box could still reach. Moving a proxy shifts its entry to the new place
+// by swapping with neighbours, which is cheap for the small moves between frames. New entries first go to a small
+// sorted side array that is merged in once it outgrows the square root of the main one, so building a large world
+// doesn't move the whole array on every insertion. Removed entries are dropped on the next merge.
+class CollisionWorld
+{
+public:
+    typedef quint32 ProxyId;
+    static const ProxyId InvalidProxy = 0xFFFFFFFFu;
+
+    // cellSize is the width of a column along y and z, a few times the size of a typical box works best
+    explicit CollisionWorld(float cellSize = 16.0f);
+
+    ProxyId add(const Obb &box, Shape *item = nullptr);
+    void update(ProxyId proxy, const Obb &box);
+    void remove(ProxyId proxy);
+    void clear();
+    int size() const;
+    Shape *item(ProxyId proxy) const;
+
+    // Whether box overlaps any proxy but ignore
+    bool overlapsAny(const Obb &box, ProxyId ignore = InvalidProxy) const;
+    // Proxies box overlaps, appended to out
+    void query(const Obb &box, std::vector<ProxyId> &out) const;
+    // Every pair of overlapping proxies once, the lower id first
+    void overlappingPairs(std::vector<std::pair<ProxyId, ProxyId>> &out);
+
+private:
+    struct Proxy {
+        Obb Box;
+        QVector3D Min;
+        QVector3D Max;
+        // Range of columns the bounds touch, y then z
+        int CellMin[2] = {};
+        int CellMax[2] = {};
+        Shape *Item = nullptr;
+        bool Alive = false;
+    };
+
+    struct Entry {
+        float MinX;
+        ProxyId Proxy;
+    };
+
+    static const int WidthBuckets = 64;
+
+    struct Column {
+        std::vector<Entry> Sorted;
+        std::vector<Entry> Pending;
+        int Size = 0;
+        // Removed entries still in Sorted
+        int Dead = 0;
+        // Entries by power of two width along x. The highest occupied bucket bounds how far left of a query
+        // overlapping entries can start, within a factor of two, and drops as soon as the wide entries leave.
+        int WidthCounts[WidthBuckets] = {};
+        int TopBucket = -1;
+    };
+
+    const float m_cellSize;
+    std::vector<Proxy> m_proxies;
+    std::vector<ProxyId> m_free;
+    std::unordered_map<quint64, Column> m_columns;
+    int m_size;
+
+    static quint64 columnKey(int y, int z);
+    static bool overlapsBounds(const Proxy &proxy, const QVector3D &min, const QVector3D &max);
+    static size_t locate(const std::vector<Entry> &entries, float minX, ProxyId proxy);
+    static void insertSorted(std::vector<Entry> &entries, const Entry &entry);
+    static int widthBucket(float width);
+    static float bucketWidth(int bucket);
+    static void addWidth(Column &column, float width);
+    static void removeWidth(Column &column, float width);
+    void cellRange(const QVector3D &min, const QVector3D &max, int *cellMin, int *cellMax) const;
+    int cell(float coordinate) const;
+    void insertEntries(ProxyId id);
+    void removeEntries(ProxyId id);
+    void merge(Column &column);
+
+    template <typename Visitor>
+    bool visitCandidates(const QVector3D &min, const QVector3D &max, Visitor visitor) const;
+};
+
+#endif    // COLLISIONWORLD_H
@@ -13,12 +13,15 @@ public:
     virtual std::shared_ptr<Material> getMaterial() override;
     virtual QMatrix4x4 &getTransformation() override;
     virtual QString ID() const override;
+    virtual bool isStatic() const override;
+    virtual void setStatic(bool isStatic) override;
 
 private:
     std::shared_ptr<Mesh> m_mesh;
     std::shared_ptr<Material> m_material;
     QMatrix4x4 m_transformation;
     QString m_id;
+    bool m_static;
 };
 
 #endif // CUBE_H
@@ -0,0 +1,39 @@
+#ifndef FRAMETIMER_H
+#define FRAMETIMER_H
+
+#include <QElapsedTimer>
+#include <QOpenGLContext>
+
+#if !QT_CONFIG(opengles2)
+#include <QOpenGLTimerQuery>
+#endif
+
+// Measures frames on the CPU and, where timer queries are available, on the GPU.
+// GPU results come in a few frames late, a frame reports its own CPU time or the latest GPU time, whichever is larger.
+class FrameTimer
+{
+public:
+    FrameTimer();
+
+    // Need the context current
+    void initialize();
+    void release();
+
+    void begin();
+    // Milliseconds the frame took
+    float end();
+
+private:
+    static const int QueryCount = 3;
+
+    QElapsedTimer m_cpuTimer;
+    float m_gpuTime;
+#if !QT_CONFIG(opengles2)
+    QOpenGLTimerQuery m_queries[QueryCount];
+    bool m_pending[QueryCount];
+    bool m_gpuTimerSupported;
+    int m_current;
+#endif
+};
+
+#endif    // FRAMETIMER_H
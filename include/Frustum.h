@@ -0,0 +1,20 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector4D>
+
+// View frustum as six inward facing planes (a, b, c, d), extracted from a view-projection matrix
+class Frustum
+{
+public:
+    explicit Frustum(const QMatrix4x4 &viewProjection);
+
+    bool intersectsSphere(const QVector3D &center, float radius) const;
+
+private:
+    QVector4D m_planes[6];
+};
+
+#endif    // FRUSTUM_H
@@ -0,0 +1,93 @@
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include <QOpenGLFunctions>
+#include <QLoggingCategory>
+#include <QMatrix4x4>
+
+#include <unordered_map>
+#include <vector>
+
+Q_DECLARE_LOGGING_CATEGORY(lcGLState)
+
+struct GLStateStats {
+    int Issued = 0;
+    int Elided = 0;
+};
+
+// Thin shadow of the GL state touched by the renderer.
+// Every setter compares against the last value it issued and skips the GL call when nothing would change,
+// so the draw loop can state its full requirements per draw without paying for them.
+// The cache assumes it is the only code changing the tracked state; call invalidate() after anything else did.
+class GLStateCache
+{
+public:
+    GLStateCache();
+
+    void initialize(QOpenGLFunctions *gl);
+    void invalidate();
+    // Forgets everything that lives in objects shared with other contexts (uniform values) or that names such objects
+    // (buffer, attribute pointer and texture bindings). Other contexts may have changed or deleted them since the last frame.
+    void invalidateShared();
+
+    // Resets the per frame counters, stats() reports the calls made since the last beginFrame()
+    void beginFrame();
+    const GLStateStats &stats() const;
+
+    void enable(GLenum cap);
+    void disable(GLenum cap);
+    void useProgram(GLuint program);
+    void bindBuffer(GLenum target, GLuint buffer);
+    void enableVertexAttribArray(GLuint index);
+    void disableVertexAttribArray(GLuint index);
+    void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, quintptr offset);
+    void setUniform(GLint location, const QMatrix4x4 &value);
+    void setUniform(GLint location, GLint value);
+    void activeTexture(GLenum unit);
+    void bindTexture(GLenum target, GLuint texture);
+
+private:
+    struct AttribPointer {
+        GLuint Buffer;
+        GLint Size;
+        GLenum Type;
+        GLboolean Normalized;
+        GLsizei Stride;
+        quintptr Offset;
+
+        bool operator==(const AttribPointer &other) const = default;
+    };
+
+    struct AttribState {
+        bool EnabledKnown = false;
+        bool Enabled = false;
+        bool PointerKnown = false;
+        AttribPointer Pointer;
+    };
+
+    QOpenGLFunctions *m_gl;
+    GLStateStats m_stats;
+
+    std::unordered_map<GLenum, bool> m_capabilities;
+    bool m_programKnown;
+    GLuint m_program;
+    bool m_arrayBufferKnown;
+    GLuint m_arrayBuffer;
+    bool m_elementBufferKnown;
+    GLuint m_elementBuffer;
+    std::vector<AttribState> m_attribs;
+    // Uniform values live in the program object, so they are keyed by (program, location)
+    std::unordered_map<quint64, QMatrix4x4> m_matrixUniforms;
+    std::unordered_map<quint64, GLint> m_intUniforms;
+    bool m_activeTextureKnown;
+    GLenum m_activeTexture;
+    // Keyed by (texture unit, target)
+    std::unordered_map<quint64, GLuint> m_textures;
+
+    void setCapability(GLenum cap, bool enabled);
+    void setAttribEnabled(GLuint index, bool enabled);
+    bool elide(bool redundant);
+    quint64 uniformKey(GLint location) const;
+};
+
+#endif    // GLSTATECACHE_H
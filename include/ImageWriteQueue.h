@@ -0,0 +1,32 @@
+#ifndef IMAGEWRITEQUEUE_H
+#define IMAGEWRITEQUEUE_H
+
+#include <QImage>
+#include <QSemaphore>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+
+// Encodes and writes images on a pool of its own, so PNG compression does not hold up the render threads.
+// At most maxPending images wait in memory, enqueue() blocks once the encoders fall that far behind.
+class ImageWriteQueue
+{
+public:
+    ImageWriteQueue(int threads, int maxPending);
+    ~ImageWriteQueue();
+
+    void enqueue(const QImage &image, const QString &path);
+    void waitForDone();
+
+    int written() const;
+    int failed() const;
+
+private:
+    QThreadPool m_pool;
+    QSemaphore m_slots;
+    std::atomic<int> m_written;
+    std::atomic<int> m_failed;
+};
+
+#endif    // IMAGEWRITEQUEUE_H
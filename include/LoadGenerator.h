@@ -0,0 +1,44 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+
+#include <vector>
+
+class QLocalSocket;
+
+struct LoadOptions {
+    QString ServerName;
+    int Shapes = 10000;
+    int UpdatesPerSecond = 200000;
+    // Transforms per message, every message is followed by a fence
+    int BatchSize = 1000;
+    int Seconds = 10;
+};
+
+// Client for the command socket that streams transform updates at a fixed rate and measures end-to-end latency:
+// the time from sending a fence to the viewer answering it after presenting a frame with everything before it.
+class LoadGenerator
+{
+public:
+    explicit LoadGenerator(const LoadOptions &options);
+
+    bool run();
+
+private:
+    LoadOptions m_options;
+    QLocalSocket *m_socket;
+    QByteArray m_buffer;
+    QElapsedTimer m_clock;
+    quint64 m_fencesSent;
+    quint64 m_fencesAnswered;
+    std::vector<qint64> m_latencies;
+
+    void sendFence(qint64 now);
+    void readFences(qint64 now);
+    bool waitForFences(int timeoutMs);
+};
+
+#endif    // LOADGENERATOR_H
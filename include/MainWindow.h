@@ -4,6 +4,8 @@
 #include <QMainWindow>
 #include <QString>
 
+#include <array>
+
 QT_BEGIN_NAMESPACE
 namespace Ui
 {
@@ -11,6 +13,10 @@ class MainWindow;
 }
 QT_END_NAMESPACE
 
+class SceneCommandServer;
+class SceneManager;
+class SceneModel;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -19,6 +25,11 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Frame time all views together may take, split evenly between them
+    void setFrameBudget(float milliseconds);
+    void setDynamicResolution(bool enabled);
+    void setStaticBatching(bool enabled);
+
 private slots:
     void on_pushButton_rotate_toggled(bool checked);
 
@@ -26,9 +37,25 @@ private slots:
 
     void on_pushButton_zoom_toggled(bool checked);
 
+    void on_pushButton_texture_clicked();
+
+    void on_pushButton_dynres_toggled(bool checked);
+
     void UpdateStatusLabel(const QString &msg);
 
 private:
+    struct ViewFrameStats {
+        float Scale = 1.0f;
+        float FrameTime = 0.0f;
+    };
+
     Ui::MainWindow *ui;
+    SceneModel *m_model;
+    SceneCommandServer *m_commandServer;
+    std::array<SceneManager *, 4> m_views;
+    std::array<ViewFrameStats, 4> m_frameStats;
+    float m_frameBudget;
+
+    void updateResolutionLabel();
 };
 #endif    // MAINWINDOW_H
@@ -1,13 +1,20 @@
 #ifndef MATERIAL_H
 #define MATERIAL_H
 
+#include <QString>
 #include <QVector4D>
 
 #define MATERIAL_COLOR_COUNT 6
 
 struct Material {
     Material();
+    bool isTransparent() const;
+
     QVector4D Color[MATERIAL_COLOR_COUNT];
+    // Image file modulating the colors, empty for an untextured material
+    QString Texture;
+    // Process wide unique id, used to group draws of the same material
+    quint32 ID;
 };
 
 #endif    // MATERIAL_H
@@ -1,6 +1,7 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <QVector2D>
 #include <QVector3D>
 #include <QVector4D>
 #include <QtOpenGL>
@@ -8,6 +9,7 @@
 struct VerticeInfo {
     QVector3D pos;
     QVector4D color;
+    QVector2D texcoord;
 };
 
 class Mesh
@@ -17,10 +19,16 @@ public:
 
     const QVector<VerticeInfo> &getVertices();
     const QVector<GLushort> &getIndices();
+    // Radius of the sphere around the local origin that contains every vertex
+    float getBoundingRadius() const;
+    // Process wide unique id, used to group draws of the same mesh
+    quint32 ID() const;
 
 private:
     QVector<VerticeInfo> m_vertices;
     QVector<GLushort> m_indices;
+    float m_boundingRadius;
+    quint32 m_id;
 };
 
 #endif    // MESH_H
@@ -0,0 +1,24 @@
+#ifndef OBB_H
+#define OBB_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+
+// Oriented bounding box: a center, three orthonormal axes and the half size along each of them
+struct Obb {
+    QVector3D Center;
+    QVector3D Axes[3];
+    QVector3D HalfExtents;
+
+    // Box of size 2 * halfExtents in local space, placed by transformation. Scaling ends up in the half extents.
+    static Obb fromTransformation(const QMatrix4x4 &transformation, const QVector3D &halfExtents = QVector3D(1.0f, 1.0f, 1.0f));
+
+    // World space box around this one
+    void bounds(QVector3D &min, QVector3D &max) const;
+    // Whether center, axes and half extents are free of NaN and infinity
+    bool isFinite() const;
+    // Separating axis test over the 15 candidate axes, touching boxes count as overlapping
+    bool intersects(const Obb &other) const;
+};
+
+#endif    // OBB_H
@@ -0,0 +1,41 @@
+#ifndef RAYMATH_H
+#define RAYMATH_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+
+// Picking and camera math. Every fast path has a straightforward reference next to it,
+// math_bench times both and checks that they agree on random input.
+namespace RayMath
+{
+struct Ray {
+    QVector3D Origin;
+    QVector3D Direction;
+};
+
+struct CameraBasis {
+    QVector3D Right;
+    QVector3D Up;
+    QMatrix4x4 View;
+};
+
+// Ray from the near plane through window position (x, y), y going up.
+// inverseViewProjection is (projection * view).inverted(), computed once per camera change instead of per ray.
+Ray screenRay(float x, float y, float width, float height, const QMatrix4x4 &inverseViewProjection);
+// Inverts projection and view separately on every call
+Ray screenRayReference(float x, float y, float width, float height, const QMatrix4x4 &projection, const QMatrix4x4 &view);
+
+// Slab test against the [-1, 1] cube placed by a rigid transformation, hits behind the ray origin don't count.
+// Reads the matrix once, straight from its storage.
+bool intersectsCube(const Ray &ray, const QMatrix4x4 &transformation);
+// Moves the ray into the cube's space through the inverted transformation and tests there, in double precision.
+// Returns the entry and exit distances, which tell how close a ray came to grazing the cube.
+bool intersectsCubeReference(const Ray &ray, const QMatrix4x4 &transformation, double *tNear = nullptr, double *tFar = nullptr);
+
+// Camera looking from position at lookAt, worldUp picks the roll
+CameraBasis cameraBasis(const QVector3D &position, const QVector3D &lookAt, const QVector3D &worldUp);
+// Same through QMatrix4x4::lookAt, which builds the basis a second time
+CameraBasis cameraBasisReference(const QVector3D &position, const QVector3D &lookAt, const QVector3D &worldUp);
+}    // namespace RayMath
+
+#endif    // RAYMATH_H
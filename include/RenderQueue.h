@@ -0,0 +1,48 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+class Shape;
+
+enum class RenderPass { OPAQUE = 0, TRANSPARENT = 1 };
+
+struct DrawItem {
+    quint64 Key;
+    Shape *Item;
+};
+
+// Per frame list of draws ordered by a 64 bit sort key.
+//
+// Opaque:      | pass:2 | program:10 | mesh:14 | material:14 | depth:24 |
+// Transparent: | pass:2 | inverted depth:24 | program:10 | mesh:14 | material:14 |
+//
+// Opaque draws are grouped by state and go front-to-back inside a group for early-Z,
+// transparent draws ignore state grouping and go strictly back-to-front.
+// Ids wider than their field are truncated, which only costs batching, not correctness.
+class RenderQueue
+{
+public:
+    RenderQueue();
+
+    void setDepthRange(float nearZ, float farZ);
+    void clear();
+    void push(RenderPass pass, quint32 program, quint32 mesh, quint32 material, float viewDepth, Shape *shape);
+    void sort();
+
+    const std::vector<DrawItem> &items() const;
+
+    static RenderPass passOf(quint64 key);
+
+private:
+    std::vector<DrawItem> m_items;
+    std::vector<DrawItem> m_scratch;
+    float m_nearZ;
+    float m_farZ;
+
+    quint32 quantizeDepth(float viewDepth) const;
+};
+
+#endif    // RENDERQUEUE_H
@@ -0,0 +1,102 @@
+#ifndef RENDERRESOURCES_H
+#define RENDERRESOURCES_H
+
+#include "TextureStreamer.h"
+
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+#include <unordered_map>
+
+class GLStateCache;
+class Mesh;
+struct StaticChunk;
+
+struct ShaderLocations {
+    int Position = -1;
+    int Color = -1;
+    int Texcoord = -1;
+    int Proj = -1;
+    int View = -1;
+    int Trans = -1;
+    int Texture = -1;
+};
+
+struct UpscaleLocations {
+    int Texture = -1;
+    int TextureSize = -1;
+    int SourceScale = -1;
+};
+
+struct GpuMesh {
+    // Buffers are released once the mesh is gone
+    std::weak_ptr<Mesh> Source;
+    QOpenGLBuffer VertexBuffer { QOpenGLBuffer::VertexBuffer };
+    QOpenGLBuffer IndexBuffer { QOpenGLBuffer::IndexBuffer };
+    int IndexCount = 0;
+};
+
+struct GpuChunk {
+    std::weak_ptr<StaticChunk> Source;
+    // Generation of the source the buffers hold, appends within one generation only upload the new tail
+    quint32 Generation = 0;
+    QOpenGLBuffer VertexBuffer { QOpenGLBuffer::VertexBuffer };
+    QOpenGLBuffer IndexBuffer { QOpenGLBuffer::IndexBuffer };
+    int VertexCapacity = 0;
+    int IndexCapacity = 0;
+    int VertexCount = 0;
+    // Source indices consumed so far, differs from IndexCount when strips are converted to triangles
+    int SourceIndexCount = 0;
+    int IndexCount = 0;
+    // GL_TRIANGLE_STRIP with primitive restart or GL_TRIANGLES
+    GLenum Mode = GL_TRIANGLES;
+};
+
+// GL objects that every view in one context share group uses: the shader programs, mesh buffers,
+// the selection axes and the textures. Each mesh is uploaded once per group, no matter how many views draw it.
+// Creation and the release of the last reference both need a context of the group to be current.
+class RenderResources
+{
+public:
+    // Resources of the current context's share group, created on first use. Returns nullptr if the shaders fail.
+    static std::shared_ptr<RenderResources> acquire(GLStateCache &state);
+    ~RenderResources();
+
+    QOpenGLShaderProgram &program();
+    const ShaderLocations &locations() const;
+    // Filters a reduced resolution frame up to the view
+    QOpenGLShaderProgram &upscaleProgram();
+    const UpscaleLocations &upscaleLocations() const;
+    TextureStreamer &textures();
+    const QOpenGLBuffer &axesBuffer() const;
+    int axesVertexCount() const;
+
+    // Buffers holding mesh, uploaded through state on first use
+    const GpuMesh &meshBuffers(const std::shared_ptr<Mesh> &mesh, GLStateCache &state);
+    // Buffers holding the merged static chunk, brought up to date with the chunk through state
+    const GpuChunk &chunkBuffers(const std::shared_ptr<StaticChunk> &chunk, GLStateCache &state);
+    // Destroys the buffers of meshes no shape holds anymore and of chunks that are gone
+    void releaseUnusedBuffers();
+    // Whether chunks are drawn as restarted strips. Needs GL_PRIMITIVE_RESTART_FIXED_INDEX to be enabled.
+    bool primitiveRestart() const;
+
+private:
+    RenderResources();
+    bool initialize(GLStateCache &state);
+
+    QOpenGLShaderProgram m_program;
+    ShaderLocations m_locations;
+    QOpenGLShaderProgram m_upscaleProgram;
+    UpscaleLocations m_upscaleLocations;
+    TextureStreamer m_textures;
+    QOpenGLBuffer m_axesBuffer;
+    int m_axesVertexCount;
+    std::unordered_map<quint32, GpuMesh> m_meshes;
+    std::unordered_map<quint32, GpuChunk> m_chunks;
+    bool m_primitiveRestart;
+
+    void uploadChunk(GpuChunk &gpu, const StaticChunk &chunk, GLStateCache &state);
+};
+
+#endif    // RENDERRESOURCES_H
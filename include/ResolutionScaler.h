@@ -0,0 +1,43 @@
+#ifndef RESOLUTIONSCALER_H
+#define RESOLUTIONSCALER_H
+
+#include <QSize>
+
+// Picks the render resolution for the next frame from measured frame times.
+// Frame cost grows with the pixel count, so the scale moves by the square root of budget / frame time.
+// It drops quickly when over budget and climbs back slowly with some headroom, which keeps it from oscillating.
+class ResolutionScaler
+{
+public:
+    ResolutionScaler();
+
+    void setBudget(float milliseconds);
+    float budget() const;
+    void reset();
+
+    // Feeds the time the last frame took, returns true if the scale changed
+    bool addFrameTime(float milliseconds);
+
+    float scale() const;
+    // Smoothed frame time
+    float frameTime() const;
+    // Size to render at for an output of fullSize, never smaller than one pixel
+    QSize renderSize(const QSize &fullSize) const;
+
+private:
+    float m_budget;
+    float m_scale;
+    float m_frameTime;
+    // Smoothed frame time scaled up to full resolution
+    float m_fullCost;
+    bool m_hasFrameTime;
+
+    const float m_min_scale = 0.25f;
+    const float m_max_step_down = 0.85f;
+    const float m_max_step_up = 1.05f;
+    // Only scale up while the frame time stays this far below the budget
+    const float m_headroom = 0.85f;
+    const float m_smoothing = 0.2f;
+};
+
+#endif    // RESOLUTIONSCALER_H
@@ -0,0 +1,107 @@
+#ifndef SCENECOMMANDSERVER_H
+#define SCENECOMMANDSERVER_H
+
+#include "SceneProtocol.h"
+#include "SpscQueue.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+class SceneModel;
+class Shape;
+
+using CommandBatch = std::unique_ptr<std::vector<SceneProtocol::Command>>;
+// Client and token of a fence that is due for an answer
+using Fence = std::pair<quint32, quint64>;
+
+// Socket side of the command server, lives on the server's I/O thread.
+// Everything that arrives on one readyRead() becomes one batch in the queue to the GUI thread.
+// While the queue is full nothing is read and each socket's read buffer is bounded,
+// so fast senders block in the socket instead of growing memory here.
+class SceneCommandReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    SceneCommandReceiver(SpscQueue<CommandBatch> &queue, std::atomic<bool> &notified);
+
+    bool listen(const QString &name);
+    void sendFences(const std::vector<Fence> &fences);
+
+signals:
+    // Emitted when the queue turns non-empty, not again until the GUI thread started draining
+    void commandsAvailable();
+
+private:
+    struct Client {
+        QLocalSocket *Socket;
+        QByteArray Buffer;
+        // Disconnected, kept until what it sent before is read
+        bool Closing = false;
+    };
+
+    SpscQueue<CommandBatch> &m_queue;
+    std::atomic<bool> &m_notified;
+    QLocalServer *m_server;
+    std::unordered_map<quint32, Client> m_clients;
+    quint32 m_nextClient;
+    // Batch that did not fit into the full queue, retried by m_retryTimer
+    CommandBatch m_stalled;
+    QTimer *m_retryTimer;
+
+    void onNewConnection();
+    void readClient(quint32 id);
+    void dropClient(quint32 id);
+    void removeClient(quint32 id);
+    void submit(CommandBatch batch);
+    void retryStalled();
+};
+
+// Local socket endpoint that lets other processes edit the scene, see SceneProtocol for the wire format.
+// Sockets are served on a thread of their own. Decoded commands are applied to the model on the GUI thread,
+// at most once per presented frame no matter how fast they come in.
+class SceneCommandServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SceneCommandServer(SceneModel *model, QObject *parent = nullptr);
+    ~SceneCommandServer();
+
+    bool listen(const QString &name);
+
+signals:
+    void cameraRequested(const QVector3D &position, const QVector3D &lookAt, float fov);
+
+public slots:
+    // Connect to the frameSwapped() of a view. Applied fences are answered and the next commands go in.
+    void onFrameSwapped();
+
+private:
+    SceneModel *m_model;
+    SpscQueue<CommandBatch> m_queue;
+    std::atomic<bool> m_notified;
+    QThread m_thread;
+    SceneCommandReceiver *m_receiver;
+    // Shapes created through the socket by their protocol id
+    std::unordered_map<quint32, Shape *> m_shapes;
+    std::vector<Fence> m_appliedFences;
+    // Commands were applied and the frame showing them has not been presented yet
+    bool m_frameInFlight;
+
+    void onCommandsAvailable();
+    void applyPending();
+};
+
+#endif    // SCENECOMMANDSERVER_H
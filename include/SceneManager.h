@@ -2,25 +2,34 @@
 #define SCENEMANAGER_H
 
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions>
-#include <QOpenGLShaderProgram>
-#include <QOpenGLBuffer>
 #include <QOpenGLDebugLogger>
 #include <QKeyEvent>
+#include <QMatrix4x4>
+#include <QPointer>
 #include <QString>
 
-#include <unordered_map>
+#include "FrameTimer.h"
+#include "ResolutionScaler.h"
+#include "SceneRenderer.h"
 
+class SceneModel;
 class Shape;
 
 enum class CameraState { NONE, ROTATE, PAN, ZOOM };
 
+// Which way a view looks at the scene, every kind but PERSPECTIVE is an orthographic view along a world axis
+enum class ViewKind { PERSPECTIVE, TOP, FRONT, SIDE };
+
 struct Camera {
     QVector3D Position;
     QVector3D LookAt;
     QVector3D Up;
     QVector3D Right;
+    // Up direction the camera basis is built from
+    QVector3D WorldUp;
     float FOV;
+    // Half of the visible world height in orthographic views
+    float OrthoHalfHeight;
     CameraState State;
 };
 
@@ -29,7 +38,9 @@ namespace Ui
 class SceneManager;
 }
 
-class SceneManager : public QOpenGLWidget, protected QOpenGLFunctions
+// One view of a SceneModel. Views only own their camera and input handling,
+// drawing goes through a SceneRenderer that shares its GL resources with the other views.
+class SceneManager : public QOpenGLWidget
 {
     Q_OBJECT
 
@@ -37,11 +48,21 @@ public:
     explicit SceneManager(QWidget *parent = nullptr);
     ~SceneManager();
 
+    void setSceneModel(SceneModel *model);
+    void setViewKind(ViewKind kind);
+    void setCamera(const QVector3D &position, const QVector3D &lookAt, float fov);
+    // Renders at a lower resolution while frames take longer than the budget, and upscales to the widget
+    void setDynamicResolution(bool enabled);
+    void setFrameBudget(float milliseconds);
+    // The upload budget of the shared textures is per presented frame, only one view of a window should spend it
+    void setStreamsTextures(bool enabled);
+
 signals:
     void UpdateStatusLabel(const QString &msg);
+    // Emitted after every frame, scale is the fraction of the widget's width and height that was rendered
+    void frameStatsChanged(float scale, float frameTime);
 
 public slots:
-    void onCreateCube();
     void onPanToggled(bool checked);
     void onRotateToggled(bool checked);
     void onZoomToggled(bool checked);
@@ -52,37 +73,39 @@ protected slots:
     void PrintLoggedMessage(const QOpenGLDebugMessage &debugMessage);
 
 protected:
-    void InitalizeShaders();
-    void InitalizeBuffers();
     void initializeGL() override;
+    void resizeGL(int w, int h) override;
     void paintGL() override;
 
 private:
     Ui::SceneManager *ui;
     QOpenGLDebugLogger m_logger;
-    QOpenGLShaderProgram m_program;
-    std::unordered_map<QString, Shape *> m_shapes;
+    SceneRenderer m_renderer;
+    QPointer<SceneModel> m_model;
+    ViewKind m_viewKind;
     QMatrix4x4 m_projection;
     QMatrix4x4 m_view;
-    QOpenGLBuffer m_arrayBuf;
-    QOpenGLBuffer m_indexBuf;
+    // Picking unprojects through this, kept up to date with the camera instead of inverted per ray
+    QMatrix4x4 m_inverseViewProjection;
     Camera m_camera;
-    Shape *m_selected_shape;
+    ResolutionScaler m_scaler;
+    FrameTimer m_frameTimer;
+    bool m_dynamicResolution;
+    bool m_streamsTextures;
 
     const float m_near_z = 2.0f;
     const float m_far_z = 200.0f;
     const float m_default_fov = 30.0f;
+    const float m_default_ortho_half_height = 20.0f;
     const float m_rotation_speed_scalar = 2.0f;
 
-    void renderAll();
+    void releaseGL();
+    void updateProjection();
+    void updateView();
     Shape *pickShape(int x, int y);
-    Shape *createShape(const QString &type, QString &id);
     void PanViewport(int key);
     void ZoomViewport(int key);
     void RotateViewport(int key);
-
-    void CastRayFromScreenToWorld(int mouseX, int mouseY, QVector3D &out_origin, QVector3D &out_direction);
-    bool RayIntersectionTest(Shape *shape, const QVector3D &ray_origin, const QVector3D &ray_direction);
 };
 
 #endif    // SCENEMANAGER_H
@@ -0,0 +1,71 @@
+#ifndef SCENEMODEL_H
+#define SCENEMODEL_H
+
+#include "CollisionWorld.h"
+#include "StaticBatcher.h"
+
+#include <QObject>
+#include <QString>
+#include <QVector3D>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Shape;
+
+// The shapes and the selection, shared by every view looking at the scene
+class SceneModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SceneModel(QObject *parent = nullptr);
+    ~SceneModel();
+
+    const std::unordered_map<QString, Shape *> &shapes() const;
+    Shape *selectedShape() const;
+    void setSelectedShape(Shape *shape);
+    // Adds count randomly placed cubes at once, for generated scenes
+    void createCubes(int count);
+    // Batched edits don't notify, call markChanged() once the batch is done.
+    // createCube() returns nullptr if the id is taken.
+    Shape *createCube(const QString &id, const QVector3D &position);
+    bool removeShape(const QString &id);
+    // Call after changing a shape's transformation, overlap queries only see where shapes were last updated
+    void updateShape(Shape *shape);
+    void markChanged();
+
+    // Merges static shapes into a few large buffers instead of drawing them one by one
+    void setStaticBatching(bool enabled);
+    bool staticBatching() const;
+    const StaticBatcher &staticBatches() const;
+
+    // Shapes whose boxes intersect, each pair once
+    std::vector<std::pair<Shape *, Shape *>> overlappingPairs();
+    // Whether a shape with this transformation would intersect any shape but ignore
+    bool overlaps(const QMatrix4x4 &transformation, Shape *ignore = nullptr) const;
+
+signals:
+    // Shapes or the selection changed, every view needs a repaint
+    void changed();
+
+public slots:
+    void onCreateCube();
+    void onCreateTexturedCube(const QString &texturePath);
+
+private:
+    std::unordered_map<QString, Shape *> m_shapes;
+    Shape *m_selected_shape;
+    StaticBatcher m_staticBatches;
+    CollisionWorld m_collisions;
+    std::unordered_map<Shape *, CollisionWorld::ProxyId> m_proxies;
+    // Half size of the box new shapes are placed in, it grows once the box gets crowded
+    float m_spawnExtent;
+
+    Shape *createShape(const QString &type, QString &id);
+    void insertShape(const QString &id, Shape *shape);
+    void placeShape(Shape *shape);
+};
+
+#endif    // SCENEMODEL_H
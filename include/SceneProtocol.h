@@ -0,0 +1,63 @@
+#ifndef SCENEPROTOCOL_H
+#define SCENEPROTOCOL_H
+
+#include <QByteArray>
+#include <QQuaternion>
+#include <QVector3D>
+
+#include <vector>
+
+// Binary protocol of the local command socket, all values little-endian.
+//
+// A message is an 8 byte header followed by count records of a fixed size per type:
+//   | type:u8 | reserved:u8[3] | count:u32 |
+//
+// CREATE      id:u32 position:f32[3]                            16 bytes, adds a cube
+// REMOVE      id:u32                                             4 bytes
+// TRANSFORM   id:u32 position:f32[3] rotation:f32[4] (x y z w)  32 bytes
+// CAMERA      position:f32[3] look-at:f32[3] fov:f32            28 bytes, count has to be 1
+// FENCE       token:u64                                          8 bytes, count has to be 1
+//
+// Floats have to be finite, a message carrying NaN or infinity is invalid like an unknown type.
+// The server echoes every FENCE back once the commands sent before it are applied and a frame showing them was presented.
+namespace SceneProtocol
+{
+enum class MessageType : quint8 { CREATE = 1, REMOVE = 2, TRANSFORM = 3, CAMERA = 4, FENCE = 5 };
+
+const char *const DefaultServerName = "QOpenGLWidget_example";
+const int HeaderSize = 8;
+// Larger messages are treated as garbage, senders split their batches
+const quint32 MaxRecords = 1 << 20;
+
+struct Command {
+    MessageType Type;
+    // Connection the command came in on, fences are answered there
+    quint32 Client;
+    quint32 Id;
+    QVector3D Position;
+    QQuaternion Rotation;
+    QVector3D LookAt;
+    float Fov;
+    quint64 Token;
+};
+
+enum class DecodeResult { OK, INCOMPLETE, INVALID };
+
+// Record size of type, -1 for unknown types
+int recordSize(MessageType type);
+
+// Decodes the message at the front of data into out and reports its length in consumed
+DecodeResult decode(const char *data, qsizetype size, quint32 client, std::vector<Command> &out, qsizetype &consumed);
+
+// Batched messages are a header followed by that many records
+void appendHeader(QByteArray &out, MessageType type, quint32 count);
+void appendCreate(QByteArray &out, quint32 id, const QVector3D &position);
+void appendRemove(QByteArray &out, quint32 id);
+void appendTransform(QByteArray &out, quint32 id, const QVector3D &position, const QQuaternion &rotation);
+
+// Complete single record messages
+void appendCameraMessage(QByteArray &out, const QVector3D &position, const QVector3D &lookAt, float fov);
+void appendFenceMessage(QByteArray &out, quint64 token);
+}
+
+#endif    // SCENEPROTOCOL_H
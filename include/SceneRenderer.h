@@ -0,0 +1,62 @@
+#ifndef SCENERENDERER_H
+#define SCENERENDERER_H
+
+#include "GLStateCache.h"
+#include "RenderQueue.h"
+#include "RenderResources.h"
+
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QMatrix4x4>
+#include <QSize>
+
+#include <memory>
+#include <vector>
+
+class Frustum;
+class SceneModel;
+class StaticBatcher;
+struct StaticChunk;
+
+// Draws a SceneModel into the currently bound framebuffer.
+// There is one renderer per view, it only owns the per view work: culling, sorting, draw submission and GL state tracking.
+// Shaders, mesh buffers and textures come from the RenderResources of the context's share group.
+class SceneRenderer : protected QOpenGLFunctions
+{
+public:
+    SceneRenderer();
+
+    // Both need the view's context current
+    bool initialize();
+    void release();
+
+    // Uploads loaded texture mips, returns true while more frames are needed to finish
+    bool uploadPending();
+    void render(const SceneModel &model, const QMatrix4x4 &projection, const QMatrix4x4 &view, float nearZ, float farZ);
+    // Renders at renderSize into an internal framebuffer and filters the result up to outputSize in outputFramebuffer.
+    // Matching sizes render straight into outputFramebuffer.
+    void renderScaled(const SceneModel &model, const QMatrix4x4 &projection, const QMatrix4x4 &view, float nearZ, float farZ,
+                      const QSize &renderSize, const QSize &outputSize, GLuint outputFramebuffer);
+
+    const GLStateStats &stats() const;
+    TextureStreamer &textures();
+
+private:
+    std::shared_ptr<RenderResources> m_resources;
+    GLStateCache m_glState;
+    RenderQueue m_renderQueue;
+    // Full output size, reduced frames only use its lower left corner so scale changes don't reallocate
+    std::unique_ptr<QOpenGLFramebufferObject> m_scaledTarget;
+
+    struct VisibleChunk {
+        float ViewDepth;
+        // Points into the batcher's chunk list, only valid during the frame
+        const std::shared_ptr<StaticChunk> *Chunk;
+    };
+    std::vector<VisibleChunk> m_visibleChunks;
+
+    void drawStaticChunks(const StaticBatcher &batches, const Frustum &frustum, const QMatrix4x4 &projection, const QMatrix4x4 &view);
+    void upscale(const QSize &renderSize, const QSize &outputSize);
+};
+
+#endif    // SCENERENDERER_H
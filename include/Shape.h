@@ -16,6 +16,9 @@ public:
     virtual std::shared_ptr<Material> getMaterial() = 0;
     virtual QMatrix4x4 &getTransformation() = 0;
     virtual QString ID() const = 0;
+    // Static shapes promise to never move again, which lets them be merged into static batches
+    virtual bool isStatic() const = 0;
+    virtual void setStatic(bool isStatic) = 0;
 };
 
 #endif    // SHAPE_H
@@ -0,0 +1,63 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer thread and one consumer thread.
+// Head and tail live on separate cache lines, so the two sides don't steal each other's line on every call.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity) :
+        m_slots(capacity + 1),
+        m_head(0),
+        m_tail(0)
+    {
+    }
+
+    // Producer side. Returns false and leaves value alone when the queue is full.
+    bool push(T &&value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = advance(tail);
+        if (next == m_head.load(std::memory_order_acquire))
+            return false;
+        m_slots[tail] = std::move(value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        value = std::move(m_slots[head]);
+        m_slots[head] = T();
+        m_head.store(advance(head), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    size_t advance(size_t index) const
+    {
+        return index + 1 == m_slots.size() ? 0 : index + 1;
+    }
+
+    std::vector<T> m_slots;
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+#endif    // SPSCQUEUE_H
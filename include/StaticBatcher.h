@@ -0,0 +1,83 @@
+#ifndef STATICBATCHER_H
+#define STATICBATCHER_H
+
+#include "Mesh.h"
+
+#include <QString>
+#include <QVector3D>
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+class Shape;
+
+// Separates the triangle strips of different shapes inside a chunk's index list
+#define STATIC_BATCH_RESTART_INDEX 0xFFFFFFFFu
+
+// Static shapes of one grid cell that share a texture, merged into a single pre-transformed vertex and index list
+struct StaticChunk {
+    // Process wide unique id, used to find the chunk's GPU buffers
+    quint32 ID;
+    QString Texture;
+    std::vector<Shape *> Shapes;
+    // Vertices in world space, draws use an identity model matrix
+    std::vector<VerticeInfo> Vertices;
+    // One triangle strip per shape, separated by STATIC_BATCH_RESTART_INDEX
+    std::vector<GLuint> Indices;
+    // Sphere around every vertex, for culling
+    QVector3D Center;
+    float Radius;
+    // Bumped whenever the data was rebuilt from scratch. Within a generation shapes are only appended,
+    // so Vertices and Indices only grow and uploaded data stays valid.
+    quint32 Generation;
+};
+
+// Merges shapes that never move into large chunks so thousands of them become a handful of draw calls.
+// Chunks are cells of a uniform grid, which keeps them small enough for frustum culling to still pay off.
+// Adding a shape appends to its chunk, removing one rebuilds only that chunk, both happen lazily on the next chunks() call.
+class StaticBatcher
+{
+public:
+    explicit StaticBatcher(float cellSize = 10.0f);
+
+    // Static and opaque, transparent shapes have to be sorted back-to-front one by one
+    static bool accepts(Shape *shape);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // Both ignore shapes that are not accepted and everything while disabled
+    void add(Shape *shape);
+    void remove(Shape *shape);
+    void clear();
+
+    // Chunks holding at least one shape, with every pending edit applied
+    const std::vector<std::shared_ptr<StaticChunk>> &chunks() const;
+
+private:
+    typedef std::tuple<int, int, int, QString> ChunkKey;
+
+    struct ChunkState {
+        std::shared_ptr<StaticChunk> Chunk;
+        // Shapes at the front of Chunk->Shapes whose geometry is already merged
+        size_t BuiltShapes = 0;
+        bool NeedsRebuild = false;
+        QVector3D Min;
+        QVector3D Max;
+    };
+
+    float m_cellSize;
+    bool m_enabled;
+    mutable std::map<ChunkKey, ChunkState> m_chunks;
+    std::unordered_map<Shape *, ChunkKey> m_shapeChunks;
+    mutable std::vector<std::shared_ptr<StaticChunk>> m_chunkList;
+    mutable bool m_dirty;
+
+    ChunkKey keyOf(Shape *shape) const;
+    static void build(ChunkState &state);
+};
+
+#endif    // STATICBATCHER_H
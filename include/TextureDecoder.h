@@ -0,0 +1,17 @@
+#ifndef TEXTUREDECODER_H
+#define TEXTUREDECODER_H
+
+#include <QtGlobal>
+
+// Software decoders for the block compressed formats the GL implementation might not sample.
+// Each call decodes one 4x4 block into 16 RGBA8 texels laid out row by row.
+namespace TextureDecoder
+{
+void decodeBC1(const uchar *block, uchar *rgba, bool punchThroughAlpha);
+void decodeBC2(const uchar *block, uchar *rgba);
+void decodeBC3(const uchar *block, uchar *rgba);
+void decodeETC2RGB(const uchar *block, uchar *rgba);
+void decodeETC2RGBA(const uchar *block, uchar *rgba);
+}
+
+#endif    // TEXTUREDECODER_H
@@ -0,0 +1,41 @@
+#ifndef TEXTUREIMAGE_H
+#define TEXTUREIMAGE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+enum class TextureFormat { RGBA8, BC1_RGB, BC1_RGBA, BC2, BC3, ETC2_RGB8, ETC2_RGBA8 };
+
+struct TextureLevel {
+    int Width;
+    int Height;
+    QByteArray Data;
+};
+
+// CPU side texture with its complete mip chain, Levels[0] is the full resolution image.
+// Safe to build on any thread, it holds no GL objects.
+struct TextureImage {
+    TextureFormat Format = TextureFormat::RGBA8;
+    QVector<TextureLevel> Levels;
+
+    // KTX2 and DDS files are read as stored, anything else goes through QImage and gets mips generated
+    bool load(const QString &path);
+    // Decodes a block compressed image to RGBA8, RGBA8 images are returned unchanged
+    TextureImage decompressed() const;
+
+    bool isNull() const;
+    bool isCompressed() const;
+    qint64 byteSize() const;
+
+    static int blockBytes(TextureFormat format);
+    static qint64 levelBytes(TextureFormat format, int width, int height);
+
+private:
+    bool loadKTX2(const QByteArray &file);
+    bool loadDDS(const QByteArray &file);
+    bool loadImage(const QString &path);
+    bool readLevels(const QByteArray &file, qint64 offset, int width, int height, int levelCount);
+};
+
+#endif    // TEXTUREIMAGE_H
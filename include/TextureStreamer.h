@@ -0,0 +1,82 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include "TextureImage.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QString>
+#include <QThreadPool>
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+class GLStateCache;
+
+// Loads textures on a worker pool and makes them resident a few mips per frame.
+// Workers only read files and decode, every GL call happens in uploadPending() with a context of the owning share group current.
+// Bindings go through the GLStateCache of whichever view is doing the work.
+class TextureStreamer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TextureStreamer(QObject *parent = nullptr);
+    ~TextureStreamer();
+
+    void initialize(GLStateCache &state);
+    void destroy();
+
+    // Texture to sample for path, white for an empty path and a placeholder until the first mip is resident.
+    // Unknown paths start loading in the background.
+    GLuint texture(const QString &path);
+    // Uploads loaded mips, smallest first, until the per frame budget is spent. Returns true while uploads are left.
+    bool uploadPending(GLStateCache &state);
+    void setUploadBudget(qint64 bytesPerFrame);
+
+signals:
+    // Emitted from a worker thread when a file finished loading and is waiting for uploadPending()
+    void textureLoaded();
+    // Emitted from uploadPending() when mips became resident, every view sampling the textures needs a repaint
+    void texturesUploaded();
+
+private:
+    enum class Residency { LOADING, STREAMING, RESIDENT, FAILED };
+
+    struct Entry {
+        Residency State = Residency::LOADING;
+        GLuint Texture = 0;
+        TextureImage Image;
+        // Next mip to upload, counting down to 0
+        int NextLevel = -1;
+        bool Sampleable = false;
+    };
+
+    struct LoadResult {
+        QString Path;
+        TextureImage Image;
+    };
+
+    QThreadPool m_pool;
+    QMutex m_loadedMutex;
+    std::vector<LoadResult> m_loaded;
+    std::unordered_map<QString, Entry> m_textures;
+    std::deque<QString> m_streaming;
+    QOpenGLBuffer m_pbo;
+    GLuint m_white;
+    GLuint m_placeholder;
+    qint64 m_uploadBudget;
+    bool m_supportsBC;
+    bool m_supportsETC2;
+    bool m_supportsPBO;
+
+    void adoptLoaded(GLStateCache &state);
+    void uploadLevel(Entry &entry, int index, GLStateCache &state);
+    GLuint createPlaceholder(const uchar *rgba, int size, GLStateCache &state);
+    void deleteTexture(GLuint texture);
+};
+
+#endif    // TEXTURESTREAMER_H
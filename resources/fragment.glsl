@@ -1,10 +1,13 @@
 #version 330
 
 in highp vec4 color;
+in highp vec2 texcoord;
+
+uniform sampler2D u_texture;
 
 out highp vec4 fragColor;
 
 void main(void)
 {
-   fragColor = color;
+   fragColor = color * texture(u_texture, texcoord);
 }
@@ -0,0 +1,49 @@
+#version 330
+
+in highp vec2 texcoord;
+
+uniform sampler2D u_texture;
+// Texel count of the whole texture
+uniform highp vec2 u_textureSize;
+// Part of the texture the scene was rendered into
+uniform highp vec2 u_sourceScale;
+
+out highp vec4 fragColor;
+
+// Catmull-Rom bicubic in 9 bilinear taps, sharper than plain bilinear when magnifying
+void main(void)
+{
+   vec2 samplePos = texcoord * u_sourceScale * u_textureSize;
+   vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+   vec2 f = samplePos - texPos1;
+
+   vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+   vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+   vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+   vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+   vec2 w12 = w1 + w2;
+   vec2 offset12 = w2 / w12;
+
+   // Taps outside the rendered region would pull in stale texels, keep them on its last row and column
+   vec2 maxTexcoord = (u_sourceScale * u_textureSize - 0.5) / u_textureSize;
+   vec2 texPos0 = min((texPos1 - 1.0) / u_textureSize, maxTexcoord);
+   vec2 texPos3 = min((texPos1 + 2.0) / u_textureSize, maxTexcoord);
+   vec2 texPos12 = min((texPos1 + offset12) / u_textureSize, maxTexcoord);
+
+   vec4 result = vec4(0.0);
+   result += texture(u_texture, vec2(texPos0.x, texPos0.y)) * w0.x * w0.y;
+   result += texture(u_texture, vec2(texPos12.x, texPos0.y)) * w12.x * w0.y;
+   result += texture(u_texture, vec2(texPos3.x, texPos0.y)) * w3.x * w0.y;
+
+   result += texture(u_texture, vec2(texPos0.x, texPos12.y)) * w0.x * w12.y;
+   result += texture(u_texture, vec2(texPos12.x, texPos12.y)) * w12.x * w12.y;
+   result += texture(u_texture, vec2(texPos3.x, texPos12.y)) * w3.x * w12.y;
+
+   result += texture(u_texture, vec2(texPos0.x, texPos3.y)) * w0.x * w3.y;
+   result += texture(u_texture, vec2(texPos12.x, texPos3.y)) * w12.x * w3.y;
+   result += texture(u_texture, vec2(texPos3.x, texPos3.y)) * w3.x * w3.y;
+
+   // The negative lobes can overshoot below zero on hard edges
+   fragColor = max(result, vec4(0.0));
+}
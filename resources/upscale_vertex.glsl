@@ -0,0 +1,11 @@
+#version 330
+
+// Single triangle covering the viewport, no vertex buffer needed
+out highp vec2 texcoord;
+
+void main(void)
+{
+   vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+   texcoord = corner;
+   gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
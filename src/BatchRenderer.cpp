@@ -0,0 +1,194 @@
+#include "BatchRenderer.h"
+#include "ImageWriteQueue.h"
+#include "SceneModel.h"
+#include "SceneRenderer.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QSurfaceFormat>
+#include <QThread>
+#include <QDebug>
+
+#include <cstring>
+#include <vector>
+
+// Same camera as the perspective view of the interactive window
+static const QVector3D s_cameraPosition(-30.0f, 30.0f, 40.0f);
+static const float s_fov = 30.0f;
+static const float s_nearZ = 2.0f;
+static const float s_farZ = 200.0f;
+
+// Narrows projection to the part of the image covered by rect (in top-down pixels), so that part fills the viewport
+static QMatrix4x4 tileProjection(const QMatrix4x4 &projection, const QSize &imageSize, const QRect &rect)
+{
+    const float left = 2.0f * rect.left() / imageSize.width() - 1.0f;
+    const float right = 2.0f * (rect.left() + rect.width()) / imageSize.width() - 1.0f;
+    const float top = 1.0f - 2.0f * rect.top() / imageSize.height();
+    const float bottom = 1.0f - 2.0f * (rect.top() + rect.height()) / imageSize.height();
+
+    QMatrix4x4 crop;
+    crop.scale(2.0f / (right - left), 2.0f / (top - bottom), 1.0f);
+    crop.translate(-(left + right) / 2.0f, -(top + bottom) / 2.0f, 0.0f);
+    return crop * projection;
+}
+
+BatchRenderer::BatchRenderer(const BatchOptions &options) :
+    m_options(options),
+    m_nextScene(0),
+    m_rendered(0)
+{
+}
+
+bool BatchRenderer::run()
+{
+    if (!QDir().mkpath(m_options.OutputDir)) {
+        qDebug() << "BatchRenderer::run: Failed to create output directory" << m_options.OutputDir;
+        return false;
+    }
+
+    QSurfaceFormat format;
+    format.setRenderableType(QSurfaceFormat::OpenGL);
+    format.setDepthBufferSize(24);
+
+    // Surfaces have to be created on the GUI thread, each context is handed to its worker before the worker starts.
+    // The contexts don't share, every worker builds its own RenderResources.
+    std::vector<Worker> workers(qMax(1, m_options.Threads));
+    bool created = true;
+    for (auto &worker : workers) {
+        worker.Surface = new QOffscreenSurface();
+        worker.Surface->setFormat(format);
+        worker.Surface->create();
+        worker.Context = new QOpenGLContext();
+        worker.Context->setFormat(format);
+        if (!worker.Surface->isValid() || !worker.Context->create()) {
+            created = false;
+            break;
+        }
+    }
+    if (!created) {
+        qDebug() << "BatchRenderer::run: Failed to create offscreen contexts!";
+        for (auto &worker : workers) {
+            delete worker.Context;
+            delete worker.Surface;
+        }
+        return false;
+    }
+
+    const int threadCount = workers.size();
+    ImageWriteQueue writer(threadCount, 2 * threadCount);
+    std::vector<QThread *> threads;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (auto &worker : workers) {
+        QThread *thread = QThread::create([this, worker, &writer]() { renderScenes(worker, writer); });
+        worker.Context->moveToThread(thread);
+        threads.push_back(thread);
+        thread->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    writer.waitForDone();
+    const qint64 elapsed = timer.elapsed();
+
+    for (auto &worker : workers) {
+        delete worker.Surface;
+    }
+
+    const double seconds = qMax<qint64>(elapsed, 1) / 1000.0;
+    qInfo().noquote() << QString("Rendered %1 of %2 images at %3x%4 with %5 threads in %6 s, %7 images/s")
+                             .arg(writer.written())
+                             .arg(m_options.SceneCount)
+                             .arg(m_options.ImageSize.width())
+                             .arg(m_options.ImageSize.height())
+                             .arg(threadCount)
+                             .arg(seconds, 0, 'f', 2)
+                             .arg(writer.written() / seconds, 0, 'f', 2);
+    return m_rendered == m_options.SceneCount && writer.failed() == 0;
+}
+
+void BatchRenderer::renderScenes(Worker worker, ImageWriteQueue &writer)
+{
+    QOpenGLContext *context = worker.Context;
+    if (!context->makeCurrent(worker.Surface)) {
+        qDebug() << "BatchRenderer::renderScenes: Failed to make offscreen context current!";
+        delete context;
+        return;
+    }
+    QOpenGLFunctions *gl = context->functions();
+
+    {
+        SceneRenderer renderer;
+        if (!renderer.initialize()) {
+            qDebug() << "BatchRenderer::renderScenes: Failed to initialize renderer!";
+        } else {
+            // Largest target the driver can take, bigger images are split into tiles of this size
+            GLint maxTextureSize = 0;
+            GLint maxRenderbufferSize = 0;
+            GLint maxViewport[2] = { 0, 0 };
+            gl->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+            gl->glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+            gl->glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+            int tileSize = qMin(qMin(maxTextureSize, maxRenderbufferSize), qMin(maxViewport[0], maxViewport[1]));
+            if (m_options.TileSize > 0) {
+                tileSize = qMin(tileSize, m_options.TileSize);
+            }
+
+            const QSize imageSize = m_options.ImageSize;
+            const QSize targetSize(qMin(tileSize, imageSize.width()), qMin(tileSize, imageSize.height()));
+            QOpenGLFramebufferObject target(targetSize, QOpenGLFramebufferObject::CombinedDepthStencil);
+
+            QMatrix4x4 projection;
+            projection.perspective(s_fov, (float)imageSize.width() / (float)imageSize.height(), s_nearZ, s_farZ);
+            QMatrix4x4 view;
+            view.lookAt(s_cameraPosition, QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f));
+
+            std::vector<uchar> pixels(targetSize.width() * targetSize.height() * 4);
+            for (int scene = m_nextScene++; scene < m_options.SceneCount; scene = m_nextScene++) {
+                SceneModel model;
+                model.setStaticBatching(m_options.StaticBatching);
+                model.createCubes(m_options.ShapesPerScene);
+
+                // Blending keeps destination alpha at 1, so the image needs no alpha channel
+                QImage image(imageSize, QImage::Format_RGBX8888);
+                if (image.isNull()) {
+                    qDebug() << "BatchRenderer::renderScenes: Failed to allocate image of" << imageSize;
+                    break;
+                }
+
+                target.bind();
+                for (int y = 0; y < imageSize.height(); y += targetSize.height()) {
+                    for (int x = 0; x < imageSize.width(); x += targetSize.width()) {
+                        const QRect rect(x, y, qMin(targetSize.width(), imageSize.width() - x),
+                                         qMin(targetSize.height(), imageSize.height() - y));
+                        gl->glViewport(0, 0, rect.width(), rect.height());
+                        renderer.render(model, tileProjection(projection, imageSize, rect), view, s_nearZ, s_farZ);
+                        gl->glReadPixels(0, 0, rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+                        // GL rows go bottom-up
+                        const int rowBytes = rect.width() * 4;
+                        for (int row = 0; row < rect.height(); row++) {
+                            uchar *dst = image.scanLine(rect.bottom() - row) + rect.left() * 4;
+                            std::memcpy(dst, pixels.data() + row * rowBytes, rowBytes);
+                        }
+                    }
+                }
+                target.release();
+
+                writer.enqueue(image, QDir(m_options.OutputDir).filePath(QString("scene_%1.png").arg(scene, 5, 10, QChar('0'))));
+                m_rendered++;
+            }
+        }
+        // GL objects go while the context is still current
+        renderer.release();
+    }
+
+    context->doneCurrent();
+    delete context;
+}
@@ -0,0 +1,367 @@
+#include "CollisionWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// A column's side array is merged once it holds more entries than this or twice the square root of the main array
+static const size_t s_minPendingCapacity = 256;
+// Removed entries are dropped once they make up a quarter of the main array
+static const int s_minDeadEntries = 64;
+// Keeps the cell index of absurdly far away boxes in range
+static const float s_maxCell = 1 << 30;
+// Width bucket 0 holds everything narrower than 2^-s_widthBucketBias, the top one everything too wide to bound
+static const int s_widthBucketBias = 16;
+
+CollisionWorld::CollisionWorld(float cellSize) :
+    m_cellSize(cellSize),
+    m_size(0)
+{
+}
+
+CollisionWorld::ProxyId CollisionWorld::add(const Obb &box, Shape *item)
+{
+    ProxyId id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    } else {
+        id = m_proxies.size();
+        m_proxies.emplace_back();
+    }
+
+    Q_ASSERT(box.isFinite());
+    Proxy &proxy = m_proxies[id];
+    proxy.Box = box;
+    box.bounds(proxy.Min, proxy.Max);
+    cellRange(proxy.Min, proxy.Max, proxy.CellMin, proxy.CellMax);
+    proxy.Item = item;
+    proxy.Alive = true;
+    insertEntries(id);
+    m_size++;
+    return id;
+}
+
+void CollisionWorld::update(ProxyId id, const Obb &box)
+{
+    Q_ASSERT(id < m_proxies.size() && m_proxies[id].Alive);
+    Q_ASSERT(box.isFinite());
+    Proxy &proxy = m_proxies[id];
+    QVector3D min;
+    QVector3D max;
+    box.bounds(min, max);
+    int cellMin[2];
+    int cellMax[2];
+    cellRange(min, max, cellMin, cellMax);
+
+    if (!std::equal(cellMin, cellMin + 2, proxy.CellMin) || !std::equal(cellMax, cellMax + 2, proxy.CellMax)) {
+        // Crossed into other columns, rare for small moves
+        removeEntries(id);
+        proxy.Box = box;
+        proxy.Min = min;
+        proxy.Max = max;
+        std::copy(cellMin, cellMin + 2, proxy.CellMin);
+        std::copy(cellMax, cellMax + 2, proxy.CellMax);
+        insertEntries(id);
+        return;
+    }
+
+    const float oldMinX = proxy.Min.x();
+    const float oldWidth = proxy.Max.x() - proxy.Min.x();
+    proxy.Box = box;
+    proxy.Min = min;
+    proxy.Max = max;
+    for (int y = cellMin[0]; y <= cellMax[0]; y++) {
+        for (int z = cellMin[1]; z <= cellMax[1]; z++) {
+            Column &column = m_columns[columnKey(y, z)];
+            removeWidth(column, oldWidth);
+            addWidth(column, max.x() - min.x());
+            std::vector<Entry> *entries = &column.Sorted;
+            size_t index = locate(*entries, oldMinX, id);
+            if (index == entries->size()) {
+                entries = &column.Pending;
+                index = locate(*entries, oldMinX, id);
+            }
+            Q_ASSERT(index < entries->size());
+            (*entries)[index].MinX = min.x();
+
+            // Shift the entry to its new place, small moves only pass a few neighbours
+            while (index > 0 && (*entries)[index - 1].MinX > (*entries)[index].MinX) {
+                std::swap((*entries)[index - 1], (*entries)[index]);
+                index--;
+            }
+            while (index + 1 < entries->size() && (*entries)[index + 1].MinX < (*entries)[index].MinX) {
+                std::swap((*entries)[index + 1], (*entries)[index]);
+                index++;
+            }
+        }
+    }
+}
+
+void CollisionWorld::remove(ProxyId id)
+{
+    Q_ASSERT(id < m_proxies.size() && m_proxies[id].Alive);
+    removeEntries(id);
+    Proxy &proxy = m_proxies[id];
+    proxy.Alive = false;
+    proxy.Item = nullptr;
+    m_free.push_back(id);
+    m_size--;
+}
+
+void CollisionWorld::clear()
+{
+    m_proxies.clear();
+    m_free.clear();
+    m_columns.clear();
+    m_size = 0;
+}
+
+int CollisionWorld::size() const
+{
+    return m_size;
+}
+
+Shape *CollisionWorld::item(ProxyId id) const
+{
+    return id < m_proxies.size() ? m_proxies[id].Item : nullptr;
+}
+
+template <typename Visitor>
+bool CollisionWorld::visitCandidates(const QVector3D &min, const QVector3D &max, Visitor visitor) const
+{
+    int cellMin[2];
+    int cellMax[2];
+    cellRange(min, max, cellMin, cellMax);
+    for (int y = cellMin[0]; y <= cellMax[0]; y++) {
+        for (int z = cellMin[1]; z <= cellMax[1]; z++) {
+            auto found = m_columns.find(columnKey(y, z));
+            if (found == m_columns.end())
+                continue;
+
+            const Column &column = found->second;
+            // Nothing that starts further left than the widest entry can still reach min
+            const float first = min.x() - bucketWidth(column.TopBucket);
+            for (const std::vector<Entry> *entries : { &column.Sorted, &column.Pending }) {
+                auto it = std::lower_bound(entries->begin(), entries->end(), first,
+                                           [](const Entry &entry, float value) { return entry.MinX < value; });
+                for (; it != entries->end() && it->MinX <= max.x(); ++it) {
+                    if (it->Proxy == InvalidProxy)
+                        continue;
+                    const Proxy &proxy = m_proxies[it->Proxy];
+                    if (!overlapsBounds(proxy, min, max))
+                        continue;
+                    // Listed in every column both touch, only the one with the lower corner of the overlap counts
+                    if (cell(qMax(min.y(), proxy.Min.y())) != y || cell(qMax(min.z(), proxy.Min.z())) != z)
+                        continue;
+                    if (!visitor(it->Proxy))
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool CollisionWorld::overlapsAny(const Obb &box, ProxyId ignore) const
+{
+    QVector3D min;
+    QVector3D max;
+    box.bounds(min, max);
+    return !visitCandidates(min, max, [&](ProxyId id) { return id == ignore || !box.intersects(m_proxies[id].Box); });
+}
+
+void CollisionWorld::query(const Obb &box, std::vector<ProxyId> &out) const
+{
+    QVector3D min;
+    QVector3D max;
+    box.bounds(min, max);
+    visitCandidates(min, max, [&](ProxyId id) {
+        if (box.intersects(m_proxies[id].Box)) {
+            out.push_back(id);
+        }
+        return true;
+    });
+}
+
+void CollisionWorld::overlappingPairs(std::vector<std::pair<ProxyId, ProxyId>> &out)
+{
+    for (auto &found : m_columns) {
+        const int y = int(found.first >> 32);
+        const int z = int(quint32(found.first));
+        Column &column = found.second;
+        // With everything in one sorted array and no holes, the sweep only looks ahead of each entry
+        merge(column);
+        const std::vector<Entry> &entries = column.Sorted;
+        for (size_t i = 0; i < entries.size(); i++) {
+            const ProxyId first = entries[i].Proxy;
+            const Proxy &a = m_proxies[first];
+            for (size_t j = i + 1; j < entries.size() && entries[j].MinX <= a.Max.x(); j++) {
+                const ProxyId second = entries[j].Proxy;
+                const Proxy &b = m_proxies[second];
+                if (!overlapsBounds(b, a.Min, a.Max))
+                    continue;
+                if (cell(qMax(a.Min.y(), b.Min.y())) != y || cell(qMax(a.Min.z(), b.Min.z())) != z)
+                    continue;
+                if (a.Box.intersects(b.Box)) {
+                    out.emplace_back(qMin(first, second), qMax(first, second));
+                }
+            }
+        }
+    }
+}
+
+quint64 CollisionWorld::columnKey(int y, int z)
+{
+    return (quint64(quint32(y)) << 32) | quint32(z);
+}
+
+bool CollisionWorld::overlapsBounds(const Proxy &proxy, const QVector3D &min, const QVector3D &max)
+{
+    return proxy.Min.x() <= max.x() && proxy.Max.x() >= min.x() && proxy.Min.y() <= max.y() && proxy.Max.y() >= min.y() &&
+           proxy.Min.z() <= max.z() && proxy.Max.z() >= min.z();
+}
+
+size_t CollisionWorld::locate(const std::vector<Entry> &entries, float minX, ProxyId id)
+{
+    // Several entries can share a bound, the proxy is among the ones with its value.
+    // Returns entries.size() if it isn't there.
+    auto it = std::lower_bound(entries.begin(), entries.end(), minX, [](const Entry &entry, float value) { return entry.MinX < value; });
+    while (it != entries.end() && it->MinX == minX && it->Proxy != id) {
+        ++it;
+    }
+    if (it == entries.end() || it->Proxy != id)
+        return entries.size();
+    return it - entries.begin();
+}
+
+void CollisionWorld::insertSorted(std::vector<Entry> &entries, const Entry &entry)
+{
+    auto it = std::upper_bound(entries.begin(), entries.end(), entry.MinX,
+                               [](float value, const Entry &other) { return value < other.MinX; });
+    entries.insert(it, entry);
+}
+
+int CollisionWorld::widthBucket(float width)
+{
+    // Bucket b holds widths below 2^(b - bias). Everything wider than the last bounded bucket, infinity and NaN
+    // included, goes to the top one, ilogb() of those would index far outside the counts.
+    if (!(width < bucketWidth(WidthBuckets - 2)))
+        return WidthBuckets - 1;
+    if (width < bucketWidth(0))
+        return 0;
+    return std::ilogb(width) + s_widthBucketBias + 1;
+}
+
+float CollisionWorld::bucketWidth(int bucket)
+{
+    if (bucket < 0)
+        return 0.0f;
+    if (bucket == WidthBuckets - 1)
+        return std::numeric_limits<float>::infinity();
+    return std::ldexp(1.0f, bucket - s_widthBucketBias);
+}
+
+void CollisionWorld::addWidth(Column &column, float width)
+{
+    const int bucket = widthBucket(width);
+    column.WidthCounts[bucket]++;
+    column.TopBucket = qMax(column.TopBucket, bucket);
+}
+
+void CollisionWorld::removeWidth(Column &column, float width)
+{
+    const int bucket = widthBucket(width);
+    Q_ASSERT(column.WidthCounts[bucket] > 0);
+    column.WidthCounts[bucket]--;
+    while (column.TopBucket >= 0 && column.WidthCounts[column.TopBucket] == 0) {
+        column.TopBucket--;
+    }
+}
+
+void CollisionWorld::cellRange(const QVector3D &min, const QVector3D &max, int *cellMin, int *cellMax) const
+{
+    cellMin[0] = cell(min.y());
+    cellMin[1] = cell(min.z());
+    cellMax[0] = cell(max.y());
+    cellMax[1] = cell(max.z());
+}
+
+int CollisionWorld::cell(float coordinate) const
+{
+    return int(qBound(-s_maxCell, std::floor(coordinate / m_cellSize), s_maxCell));
+}
+
+void CollisionWorld::insertEntries(ProxyId id)
+{
+    const Proxy &proxy = m_proxies[id];
+    for (int y = proxy.CellMin[0]; y <= proxy.CellMax[0]; y++) {
+        for (int z = proxy.CellMin[1]; z <= proxy.CellMax[1]; z++) {
+            Column &column = m_columns[columnKey(y, z)];
+            addWidth(column, proxy.Max.x() - proxy.Min.x());
+            insertSorted(column.Pending, { proxy.Min.x(), id });
+            column.Size++;
+            if (column.Pending.size() > qMax(s_minPendingCapacity, size_t(2.0 * std::sqrt(double(column.Sorted.size()))))) {
+                merge(column);
+            }
+        }
+    }
+}
+
+void CollisionWorld::removeEntries(ProxyId id)
+{
+    const Proxy &proxy = m_proxies[id];
+    for (int y = proxy.CellMin[0]; y <= proxy.CellMax[0]; y++) {
+        for (int z = proxy.CellMin[1]; z <= proxy.CellMax[1]; z++) {
+            auto found = m_columns.find(columnKey(y, z));
+            Q_ASSERT(found != m_columns.end());
+            Column &column = found->second;
+            removeWidth(column, proxy.Max.x() - proxy.Min.x());
+            if (--column.Size == 0) {
+                m_columns.erase(found);
+                continue;
+            }
+
+            const size_t index = locate(column.Sorted, proxy.Min.x(), id);
+            if (index < column.Sorted.size()) {
+                // Erasing would move the rest of the array, mark the entry and leave it for the next merge
+                column.Sorted[index].Proxy = InvalidProxy;
+                column.Dead++;
+            } else {
+                column.Pending.erase(column.Pending.begin() + locate(column.Pending, proxy.Min.x(), id));
+            }
+
+            if (column.Dead > s_minDeadEntries && size_t(column.Dead) > column.Sorted.size() / 4) {
+                merge(column);
+            }
+        }
+    }
+}
+
+void CollisionWorld::merge(Column &column)
+{
+    if (column.Pending.empty() && column.Dead == 0)
+        return;
+
+    std::vector<Entry> merged;
+    merged.reserve(column.Size);
+    auto keep = [&](const Entry &entry) {
+        if (entry.Proxy != InvalidProxy) {
+            merged.push_back(entry);
+        }
+    };
+
+    auto sorted = column.Sorted.begin();
+    auto pending = column.Pending.begin();
+    while (sorted != column.Sorted.end() || pending != column.Pending.end()) {
+        if (pending == column.Pending.end() || (sorted != column.Sorted.end() && sorted->MinX <= pending->MinX)) {
+            keep(*sorted++);
+        } else {
+            keep(*pending++);
+        }
+    }
+
+    column.Sorted.swap(merged);
+    column.Pending.clear();
+    column.Dead = 0;
+}
@@ -4,47 +4,48 @@
 #include <QQuaternion>
 
 Cube::Cube(const QString &id) :
-    m_id(id)
+    m_id(id),
+    m_static(false)
 {
     m_material = std::make_shared<Material>();
 
     // clang-format off
     QVector<VerticeInfo> vertices = {
         // Vertex data for face 0
-        {QVector3D(-1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v0
-        {QVector3D( 1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v1
-        {QVector3D(-1.0f,  1.0f,  1.0f), m_material->Color[0]}, // v2
-        {QVector3D( 1.0f,  1.0f,  1.0f), m_material->Color[0]}, // v3
+        {QVector3D(-1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(0.0f, 0.0f)}, // v0
+        {QVector3D( 1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(1.0f, 0.0f)}, // v1
+        {QVector3D(-1.0f,  1.0f,  1.0f), m_material->Color[0],              QVector2D(0.0f, 1.0f)}, // v2
+        {QVector3D( 1.0f,  1.0f,  1.0f), m_material->Color[0],              QVector2D(1.0f, 1.0f)}, // v3
 
         // Vertex data for face 1
-        {QVector3D( 1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v4
-        {QVector3D( 1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v5
-        {QVector3D( 1.0f,  1.0f,  1.0f), m_material->Color[1]}, // v6
-        {QVector3D( 1.0f,  1.0f, -1.0f), m_material->Color[1]}, // v7
+        {QVector3D( 1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(0.0f, 0.0f)}, // v4
+        {QVector3D( 1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(1.0f, 0.0f)}, // v5
+        {QVector3D( 1.0f,  1.0f,  1.0f), m_material->Color[1],              QVector2D(0.0f, 1.0f)}, // v6
+        {QVector3D( 1.0f,  1.0f, -1.0f), m_material->Color[1],              QVector2D(1.0f, 1.0f)}, // v7
 
         // Vertex data for face 2
-        {QVector3D( 1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v8
-        {QVector3D(-1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v9
-        {QVector3D( 1.0f,  1.0f, -1.0f), m_material->Color[2]}, // v10
-        {QVector3D(-1.0f,  1.0f, -1.0f), m_material->Color[2]}, // v11
+        {QVector3D( 1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(0.0f, 0.0f)}, // v8
+        {QVector3D(-1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(1.0f, 0.0f)}, // v9
+        {QVector3D( 1.0f,  1.0f, -1.0f), m_material->Color[2],              QVector2D(0.0f, 1.0f)}, // v10
+        {QVector3D(-1.0f,  1.0f, -1.0f), m_material->Color[2],              QVector2D(1.0f, 1.0f)}, // v11
 
         // Vertex data for face 3
-        {QVector3D(-1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v12
-        {QVector3D(-1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f)}, // v13
-        {QVector3D(-1.0f,  1.0f, -1.0f), m_material->Color[3]}, // v14
-        {QVector3D(-1.0f,  1.0f,  1.0f), m_material->Color[3]}, // v15
+        {QVector3D(-1.0f, -1.0f, -1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(0.0f, 0.0f)}, // v12
+        {QVector3D(-1.0f, -1.0f,  1.0f), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector2D(1.0f, 0.0f)}, // v13
+        {QVector3D(-1.0f,  1.0f, -1.0f), m_material->Color[3],              QVector2D(0.0f, 1.0f)}, // v14
+        {QVector3D(-1.0f,  1.0f,  1.0f), m_material->Color[3],              QVector2D(1.0f, 1.0f)}, // v15
 
         // Vertex data for face 4
-        {QVector3D(-1.0f, -1.0f, -1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f)}, // v16
-        {QVector3D( 1.0f, -1.0f, -1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f)}, // v17
-        {QVector3D(-1.0f, -1.0f,  1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f)}, // v18
-        {QVector3D( 1.0f, -1.0f,  1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f)}, // v19
+        {QVector3D(-1.0f, -1.0f, -1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f), QVector2D(0.0f, 0.0f)}, // v16
+        {QVector3D( 1.0f, -1.0f, -1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f), QVector2D(1.0f, 0.0f)}, // v17
+        {QVector3D(-1.0f, -1.0f,  1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f), QVector2D(0.0f, 1.0f)}, // v18
+        {QVector3D( 1.0f, -1.0f,  1.0f), QVector4D(0.5f, 0.5f, 0.5f, 1.0f), QVector2D(1.0f, 1.0f)}, // v19
 
         // Vertex data for face 5
-        {QVector3D(-1.0f,  1.0f,  1.0f), m_material->Color[5]}, // v20
-        {QVector3D( 1.0f,  1.0f,  1.0f), m_material->Color[5]}, // v21
-        {QVector3D(-1.0f,  1.0f, -1.0f), m_material->Color[5]}, // v22
-        {QVector3D( 1.0f,  1.0f, -1.0f), m_material->Color[5]}  // v23
+        {QVector3D(-1.0f,  1.0f,  1.0f), m_material->Color[5],              QVector2D(0.0f, 0.0f)}, // v20
+        {QVector3D( 1.0f,  1.0f,  1.0f), m_material->Color[5],              QVector2D(1.0f, 0.0f)}, // v21
+        {QVector3D(-1.0f,  1.0f, -1.0f), m_material->Color[5],              QVector2D(0.0f, 1.0f)}, // v22
+        {QVector3D( 1.0f,  1.0f, -1.0f), m_material->Color[5],              QVector2D(1.0f, 1.0f)}  // v23
     };
 
     QVector<GLushort> indices = {
@@ -84,3 +85,13 @@ QString Cube::ID() const
 {
     return m_id;
 }
+
+bool Cube::isStatic() const
+{
+    return m_static;
+}
+
+void Cube::setStatic(bool isStatic)
+{
+    m_static = isStatic;
+}
@@ -0,0 +1,67 @@
+#include "FrameTimer.h"
+
+FrameTimer::FrameTimer() :
+    m_gpuTime(0.0f)
+#if !QT_CONFIG(opengles2)
+    ,
+    m_pending { false, false, false },
+    m_gpuTimerSupported(false),
+    m_current(0)
+#endif
+{
+}
+
+void FrameTimer::initialize()
+{
+    m_gpuTime = 0.0f;
+#if !QT_CONFIG(opengles2)
+    m_gpuTimerSupported = true;
+    for (int i = 0; i < QueryCount; i++) {
+        m_gpuTimerSupported = m_gpuTimerSupported && m_queries[i].create();
+        m_pending[i] = false;
+    }
+    m_current = 0;
+#endif
+}
+
+void FrameTimer::release()
+{
+#if !QT_CONFIG(opengles2)
+    for (int i = 0; i < QueryCount; i++) {
+        m_queries[i].destroy();
+        m_pending[i] = false;
+    }
+    m_gpuTimerSupported = false;
+#endif
+}
+
+void FrameTimer::begin()
+{
+    m_cpuTimer.start();
+#if !QT_CONFIG(opengles2)
+    if (m_gpuTimerSupported) {
+        // A query still running from QueryCount frames ago is dropped rather than waited for
+        m_pending[m_current] = false;
+        m_queries[m_current].begin();
+    }
+#endif
+}
+
+float FrameTimer::end()
+{
+    const float cpuTime = m_cpuTimer.nsecsElapsed() / 1e6f;
+#if !QT_CONFIG(opengles2)
+    if (m_gpuTimerSupported) {
+        m_queries[m_current].end();
+        m_pending[m_current] = true;
+        m_current = (m_current + 1) % QueryCount;
+
+        // The oldest query is the one most likely to be done
+        if (m_pending[m_current] && m_queries[m_current].isResultAvailable()) {
+            m_gpuTime = m_queries[m_current].waitForResult() / 1e6f;
+            m_pending[m_current] = false;
+        }
+    }
+#endif
+    return qMax(cpuTime, m_gpuTime);
+}
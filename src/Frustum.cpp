@@ -0,0 +1,31 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const QMatrix4x4 &viewProjection)
+{
+    // Gribb/Hartmann plane extraction, clip space is -w <= x, y, z <= w
+    const QVector4D row0 = viewProjection.row(0);
+    const QVector4D row1 = viewProjection.row(1);
+    const QVector4D row2 = viewProjection.row(2);
+    const QVector4D row3 = viewProjection.row(3);
+
+    m_planes[0] = row3 + row0;    // Left
+    m_planes[1] = row3 - row0;    // Right
+    m_planes[2] = row3 + row1;    // Bottom
+    m_planes[3] = row3 - row1;    // Top
+    m_planes[4] = row3 + row2;    // Near
+    m_planes[5] = row3 - row2;    // Far
+
+    for (auto &plane : m_planes) {
+        plane /= plane.toVector3D().length();
+    }
+}
+
+bool Frustum::intersectsSphere(const QVector3D &center, float radius) const
+{
+    for (const auto &plane : m_planes) {
+        if (QVector3D::dotProduct(plane.toVector3D(), center) + plane.w() < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
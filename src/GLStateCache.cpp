@@ -0,0 +1,217 @@
+#include "GLStateCache.h"
+
+Q_LOGGING_CATEGORY(lcGLState, "scene.glstate", QtInfoMsg)
+
+GLStateCache::GLStateCache() :
+    m_gl(nullptr),
+    m_programKnown(false),
+    m_program(0),
+    m_arrayBufferKnown(false),
+    m_arrayBuffer(0),
+    m_elementBufferKnown(false),
+    m_elementBuffer(0),
+    m_activeTextureKnown(false),
+    m_activeTexture(GL_TEXTURE0)
+{
+}
+
+void GLStateCache::initialize(QOpenGLFunctions *gl)
+{
+    m_gl = gl;
+    GLint maxAttribs = 0;
+    m_gl->glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+    m_attribs.assign(qMax(maxAttribs, 16), AttribState());
+    invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+    m_capabilities.clear();
+    m_programKnown = false;
+    m_arrayBufferKnown = false;
+    m_elementBufferKnown = false;
+    for (auto &attrib : m_attribs) {
+        attrib = AttribState();
+    }
+    m_matrixUniforms.clear();
+    m_intUniforms.clear();
+    m_activeTextureKnown = false;
+    m_textures.clear();
+}
+
+void GLStateCache::invalidateShared()
+{
+    m_arrayBufferKnown = false;
+    m_elementBufferKnown = false;
+    for (auto &attrib : m_attribs) {
+        attrib.PointerKnown = false;
+    }
+    m_matrixUniforms.clear();
+    m_intUniforms.clear();
+    m_textures.clear();
+}
+
+void GLStateCache::beginFrame()
+{
+    m_stats = GLStateStats();
+}
+
+const GLStateStats &GLStateCache::stats() const
+{
+    return m_stats;
+}
+
+void GLStateCache::enable(GLenum cap)
+{
+    setCapability(cap, true);
+}
+
+void GLStateCache::disable(GLenum cap)
+{
+    setCapability(cap, false);
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+    if (elide(m_programKnown && m_program == program))
+        return;
+    m_gl->glUseProgram(program);
+    m_programKnown = true;
+    m_program = program;
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    bool *known = nullptr;
+    GLuint *bound = nullptr;
+    if (target == GL_ARRAY_BUFFER) {
+        known = &m_arrayBufferKnown;
+        bound = &m_arrayBuffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        known = &m_elementBufferKnown;
+        bound = &m_elementBuffer;
+    }
+
+    if (known && elide(*known && *bound == buffer))
+        return;
+    m_gl->glBindBuffer(target, buffer);
+    if (known) {
+        *known = true;
+        *bound = buffer;
+    } else {
+        m_stats.Issued++;
+    }
+}
+
+void GLStateCache::enableVertexAttribArray(GLuint index)
+{
+    setAttribEnabled(index, true);
+}
+
+void GLStateCache::disableVertexAttribArray(GLuint index)
+{
+    setAttribEnabled(index, false);
+}
+
+void GLStateCache::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, quintptr offset)
+{
+    Q_ASSERT(index < m_attribs.size());
+    // The pointer captures the array buffer bound at the time of the call, so that buffer has to go through the cache too
+    Q_ASSERT(m_arrayBufferKnown);
+    AttribState &attrib = m_attribs[index];
+    const AttribPointer pointer = { m_arrayBuffer, size, type, normalized, stride, offset };
+    if (elide(attrib.PointerKnown && attrib.Pointer == pointer))
+        return;
+    m_gl->glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<const void *>(offset));
+    attrib.PointerKnown = true;
+    attrib.Pointer = pointer;
+}
+
+void GLStateCache::setUniform(GLint location, const QMatrix4x4 &value)
+{
+    if (location < 0)
+        return;
+    const quint64 key = uniformKey(location);
+    auto it = m_matrixUniforms.find(key);
+    if (elide(it != m_matrixUniforms.end() && it->second == value))
+        return;
+    m_gl->glUniformMatrix4fv(location, 1, GL_FALSE, value.constData());
+    m_matrixUniforms[key] = value;
+}
+
+void GLStateCache::setUniform(GLint location, GLint value)
+{
+    if (location < 0)
+        return;
+    const quint64 key = uniformKey(location);
+    auto it = m_intUniforms.find(key);
+    if (elide(it != m_intUniforms.end() && it->second == value))
+        return;
+    m_gl->glUniform1i(location, value);
+    m_intUniforms[key] = value;
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+    if (elide(m_activeTextureKnown && m_activeTexture == unit))
+        return;
+    m_gl->glActiveTexture(unit);
+    m_activeTextureKnown = true;
+    m_activeTexture = unit;
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    // Bindings are per unit, so the active unit has to go through the cache first
+    Q_ASSERT(m_activeTextureKnown);
+    const quint64 key = (quint64(m_activeTexture) << 32) | target;
+    auto it = m_textures.find(key);
+    if (elide(it != m_textures.end() && it->second == texture))
+        return;
+    m_gl->glBindTexture(target, texture);
+    m_textures[key] = texture;
+}
+
+void GLStateCache::setCapability(GLenum cap, bool enabled)
+{
+    auto it = m_capabilities.find(cap);
+    if (elide(it != m_capabilities.end() && it->second == enabled))
+        return;
+    if (enabled) {
+        m_gl->glEnable(cap);
+    } else {
+        m_gl->glDisable(cap);
+    }
+    m_capabilities[cap] = enabled;
+}
+
+void GLStateCache::setAttribEnabled(GLuint index, bool enabled)
+{
+    Q_ASSERT(index < m_attribs.size());
+    AttribState &attrib = m_attribs[index];
+    if (elide(attrib.EnabledKnown && attrib.Enabled == enabled))
+        return;
+    if (enabled) {
+        m_gl->glEnableVertexAttribArray(index);
+    } else {
+        m_gl->glDisableVertexAttribArray(index);
+    }
+    attrib.EnabledKnown = true;
+    attrib.Enabled = enabled;
+}
+
+quint64 GLStateCache::uniformKey(GLint location) const
+{
+    Q_ASSERT(m_programKnown);
+    return (quint64(m_program) << 32) | quint32(location);
+}
+
+bool GLStateCache::elide(bool redundant)
+{
+    if (redundant) {
+        m_stats.Elided++;
+    } else {
+        m_stats.Issued++;
+    }
+    return redundant;
+}
@@ -0,0 +1,45 @@
+#include "ImageWriteQueue.h"
+
+#include <QDebug>
+
+ImageWriteQueue::ImageWriteQueue(int threads, int maxPending) :
+    m_slots(maxPending),
+    m_written(0),
+    m_failed(0)
+{
+    m_pool.setMaxThreadCount(threads);
+}
+
+ImageWriteQueue::~ImageWriteQueue()
+{
+    waitForDone();
+}
+
+void ImageWriteQueue::enqueue(const QImage &image, const QString &path)
+{
+    m_slots.acquire();
+    m_pool.start([this, image, path]() {
+        if (image.save(path, "PNG")) {
+            m_written++;
+        } else {
+            qDebug() << "ImageWriteQueue: Failed to write" << path;
+            m_failed++;
+        }
+        m_slots.release();
+    });
+}
+
+void ImageWriteQueue::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+int ImageWriteQueue::written() const
+{
+    return m_written;
+}
+
+int ImageWriteQueue::failed() const
+{
+    return m_failed;
+}
@@ -0,0 +1,178 @@
+#include "LoadGenerator.h"
+#include "SceneProtocol.h"
+
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QQuaternion>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+using SceneProtocol::MessageType;
+
+// Writes are held back while this much is still queued in the socket, a slow viewer then lowers the rate
+static const qint64 s_maxBytesToWrite = 8 * 1024 * 1024;
+
+static qint64 percentile(const std::vector<qint64> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[size_t(p * (sorted.size() - 1))];
+}
+
+// Cubes circle around the y axis on rings, so updates are visible in every view
+static QVector3D orbit(quint32 id, int shapes, double seconds)
+{
+    const double slot = double(id) / qMax(1, shapes);
+    const double radius = 4.0 + 12.0 * slot;
+    const double angle = slot * 6.283185307 * 7.0 + seconds * (0.5 + slot);
+    return QVector3D(float(radius * std::cos(angle)), float(8.0 * slot - 4.0), float(radius * std::sin(angle)));
+}
+
+LoadGenerator::LoadGenerator(const LoadOptions &options) :
+    m_options(options),
+    m_socket(nullptr),
+    m_fencesSent(0),
+    m_fencesAnswered(0)
+{
+}
+
+bool LoadGenerator::run()
+{
+    QLocalSocket socket;
+    m_socket = &socket;
+    socket.connectToServer(m_options.ServerName);
+    if (!socket.waitForConnected(3000)) {
+        qDebug() << "LoadGenerator::run: Failed to connect to" << m_options.ServerName << ":" << socket.errorString();
+        return false;
+    }
+    m_clock.start();
+
+    // Create all shapes, the first fence tells when they are on screen
+    QByteArray message;
+    const quint32 shapes = quint32(m_options.Shapes);
+    for (quint32 first = 0; first < shapes; first += SceneProtocol::MaxRecords) {
+        const quint32 count = qMin(shapes - first, SceneProtocol::MaxRecords);
+        SceneProtocol::appendHeader(message, MessageType::CREATE, count);
+        for (quint32 id = first; id < first + count; id++) {
+            SceneProtocol::appendCreate(message, id, orbit(id, m_options.Shapes, 0.0));
+        }
+    }
+    socket.write(message);
+    sendFence(m_clock.nsecsElapsed());
+    if (!waitForFences(10000)) {
+        qDebug() << "LoadGenerator::run: Viewer did not answer after creating the shapes";
+        return false;
+    }
+    const qint64 createLatency = m_latencies.back();
+    m_latencies.clear();
+
+    // Stream transforms at the requested rate, cycling through the shapes
+    const int batchSize = qMax(1, qMin(m_options.BatchSize, int(SceneProtocol::MaxRecords)));
+    const qint64 start = m_clock.nsecsElapsed();
+    const qint64 duration = qint64(m_options.Seconds) * 1000000000;
+    quint64 sent = 0;
+    quint32 nextShape = 0;
+    for (qint64 now = start; now - start < duration; now = m_clock.nsecsElapsed()) {
+        const quint64 due = quint64(double(m_options.UpdatesPerSecond) * (now - start) / 1e9);
+        const double seconds = (now - start) / 1e9;
+        while (sent + batchSize <= due && socket.bytesToWrite() < s_maxBytesToWrite) {
+            message.clear();
+            SceneProtocol::appendHeader(message, MessageType::TRANSFORM, batchSize);
+            for (int i = 0; i < batchSize; i++) {
+                const QQuaternion rotation = QQuaternion::fromAxisAndAngle(QVector3D(0.3f, 1.0f, 0.2f), float(seconds * 90.0 + nextShape));
+                SceneProtocol::appendTransform(message, nextShape, orbit(nextShape, m_options.Shapes, seconds), rotation);
+                nextShape = (nextShape + 1) % qMax(1u, shapes);
+            }
+            socket.write(message);
+            sendFence(m_clock.nsecsElapsed());
+            sent += batchSize;
+        }
+        socket.flush();
+        if (socket.waitForReadyRead(1)) {
+            readFences(m_clock.nsecsElapsed());
+        }
+        if (socket.state() != QLocalSocket::ConnectedState) {
+            qDebug() << "LoadGenerator::run: Viewer closed the connection";
+            return false;
+        }
+    }
+    const double streamed = (m_clock.nsecsElapsed() - start) / 1e9;
+    const bool answered = waitForFences(10000);
+    std::vector<qint64> latencies = m_latencies;
+    const quint64 fences = latencies.size() + (m_fencesSent - m_fencesAnswered);
+
+    // Leave the scene as it was
+    message.clear();
+    for (quint32 first = 0; first < shapes; first += SceneProtocol::MaxRecords) {
+        const quint32 count = qMin(shapes - first, SceneProtocol::MaxRecords);
+        SceneProtocol::appendHeader(message, MessageType::REMOVE, count);
+        for (quint32 id = first; id < first + count; id++) {
+            SceneProtocol::appendRemove(message, id);
+        }
+    }
+    socket.write(message);
+    sendFence(m_clock.nsecsElapsed());
+    waitForFences(10000);
+    socket.disconnectFromServer();
+
+    std::sort(latencies.begin(), latencies.end());
+    qInfo().noquote() << QString("Created %1 shapes in %2 ms").arg(shapes).arg(createLatency / 1e6, 0, 'f', 2);
+    qInfo().noquote() << QString("Sent %1 transforms in %2 s, %3 updates/s")
+                             .arg(sent)
+                             .arg(streamed, 0, 'f', 2)
+                             .arg(sent / streamed, 0, 'f', 0);
+    qInfo().noquote() << QString("Fences answered %1/%2, latency ms p50 %3 p95 %4 p99 %5 max %6")
+                             .arg(latencies.size())
+                             .arg(fences)
+                             .arg(percentile(latencies, 0.50) / 1e6, 0, 'f', 2)
+                             .arg(percentile(latencies, 0.95) / 1e6, 0, 'f', 2)
+                             .arg(percentile(latencies, 0.99) / 1e6, 0, 'f', 2)
+                             .arg(latencies.empty() ? 0.0 : latencies.back() / 1e6, 0, 'f', 2);
+    return answered;
+}
+
+void LoadGenerator::sendFence(qint64 now)
+{
+    // The token is the send time, answers carry it back
+    QByteArray message;
+    SceneProtocol::appendFenceMessage(message, quint64(now));
+    m_socket->write(message);
+    m_fencesSent++;
+}
+
+void LoadGenerator::readFences(qint64 now)
+{
+    m_buffer.append(m_socket->readAll());
+    std::vector<SceneProtocol::Command> commands;
+    qsizetype offset = 0;
+    qsizetype consumed = 0;
+    while (SceneProtocol::decode(m_buffer.constData() + offset, m_buffer.size() - offset, 0, commands, consumed) ==
+           SceneProtocol::DecodeResult::OK) {
+        offset += consumed;
+    }
+    m_buffer.remove(0, offset);
+
+    for (const auto &command : commands) {
+        if (command.Type == MessageType::FENCE) {
+            m_latencies.push_back(now - qint64(command.Token));
+            m_fencesAnswered++;
+        }
+    }
+}
+
+bool LoadGenerator::waitForFences(int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < timeoutMs) {
+        m_socket->flush();
+        if (m_socket->waitForReadyRead(10)) {
+            readFences(m_clock.nsecsElapsed());
+        }
+        if (m_fencesAnswered == m_fencesSent)
+            return true;
+    }
+    return m_fencesAnswered == m_fencesSent;
+}
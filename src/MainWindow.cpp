@@ -1,11 +1,19 @@
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
+#include "SceneCommandServer.h"
+#include "SceneModel.h"
 
+#include <QFileDialog>
 #include <QSurfaceFormat>
 
+#include <utility>
+
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    m_model(nullptr),
+    m_commandServer(nullptr),
+    m_frameBudget(16.6f)
 {
     ui->setupUi(this);
     QSurfaceFormat glFormat;
@@ -13,13 +21,40 @@ MainWindow::MainWindow(QWidget *parent) :
     glFormat.setDepthBufferSize(24);
     glFormat.setOption(QSurfaceFormat::DebugContext);
 
-    ui->scene->setFormat(glFormat);
+    // Created after the views so it outlives them on destruction
+    m_model = new SceneModel(this);
+
+    const std::pair<SceneManager *, ViewKind> views[] = { { ui->scene, ViewKind::PERSPECTIVE },
+                                                          { ui->scene_top, ViewKind::TOP },
+                                                          { ui->scene_front, ViewKind::FRONT },
+                                                          { ui->scene_side, ViewKind::SIDE } };
+    for (size_t i = 0; i < m_views.size(); i++) {
+        const auto &view = views[i];
+        SceneManager *scene = view.first;
+        m_views[i] = scene;
+        scene->setFormat(glFormat);
+        scene->setViewKind(view.second);
+        scene->setSceneModel(m_model);
+        // All views present in the same window frame, the perspective view alone spends the texture upload budget
+        scene->setStreamsTextures(scene == ui->scene);
+        connect(ui->pushButton_pan, &QPushButton::toggled, scene, &SceneManager::onPanToggled);
+        connect(ui->pushButton_rotate, &QPushButton::toggled, scene, &SceneManager::onRotateToggled);
+        connect(ui->pushButton_zoom, &QPushButton::toggled, scene, &SceneManager::onZoomToggled);
+        connect(scene, &SceneManager::UpdateStatusLabel, this, &MainWindow::UpdateStatusLabel);
+        connect(scene, &SceneManager::frameStatsChanged, this, [this, i](float scale, float frameTime) {
+            m_frameStats[i] = { scale, frameTime };
+            updateResolutionLabel();
+        });
+    }
+    setFrameBudget(m_frameBudget);
     ui->scene->setFocus();
-    connect(ui->pushButton_cube, &QPushButton::clicked, ui->scene, &SceneManager::onCreateCube);
-    connect(ui->pushButton_pan, &QPushButton::toggled, ui->scene, &SceneManager::onPanToggled);
-    connect(ui->pushButton_rotate, &QPushButton::toggled, ui->scene, &SceneManager::onRotateToggled);
-    connect(ui->pushButton_zoom, &QPushButton::toggled, ui->scene, &SceneManager::onZoomToggled);
-    connect(ui->scene, &SceneManager::UpdateStatusLabel, this, &MainWindow::UpdateStatusLabel);
+    connect(ui->pushButton_cube, &QPushButton::clicked, m_model, &SceneModel::onCreateCube);
+
+    // External processes edit the scene through a local socket, paced by the frames of the perspective view
+    m_commandServer = new SceneCommandServer(m_model, this);
+    connect(ui->scene, &QOpenGLWidget::frameSwapped, m_commandServer, &SceneCommandServer::onFrameSwapped);
+    connect(m_commandServer, &SceneCommandServer::cameraRequested, ui->scene, &SceneManager::setCamera);
+    m_commandServer->listen(SceneProtocol::DefaultServerName);
 }
 
 MainWindow::~MainWindow()
@@ -27,6 +62,45 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+void MainWindow::setFrameBudget(float milliseconds)
+{
+    m_frameBudget = milliseconds;
+    // All views paint within the same window frame
+    for (SceneManager *scene : m_views) {
+        scene->setFrameBudget(milliseconds / m_views.size());
+    }
+    updateResolutionLabel();
+}
+
+void MainWindow::setDynamicResolution(bool enabled)
+{
+    // Toggling the button applies it to the views
+    ui->pushButton_dynres->setChecked(enabled);
+}
+
+void MainWindow::setStaticBatching(bool enabled)
+{
+    m_model->setStaticBatching(enabled);
+}
+
+void MainWindow::updateResolutionLabel()
+{
+    float minScale = 1.0f;
+    float maxScale = 0.0f;
+    float frameTime = 0.0f;
+    for (const ViewFrameStats &stats : m_frameStats) {
+        minScale = qMin(minScale, stats.Scale);
+        maxScale = qMax(maxScale, stats.Scale);
+        frameTime += stats.FrameTime;
+    }
+
+    const int minPercent = qRound(minScale * 100.0f);
+    const int maxPercent = qRound(maxScale * 100.0f);
+    const QString resolution = minPercent == maxPercent ? QString("%1%").arg(minPercent) : QString("%1-%2%").arg(minPercent).arg(maxPercent);
+    ui->label_resolution->setText(
+        QString("Resolution %1, frame %2 / %3 ms").arg(resolution).arg(frameTime, 0, 'f', 1).arg(m_frameBudget, 0, 'f', 1));
+}
+
 void MainWindow::UpdateStatusLabel(const QString &msg)
 {
     ui->label_message->setText(msg);
@@ -55,3 +129,19 @@ void MainWindow::on_pushButton_zoom_toggled(bool checked)
         ui->pushButton_rotate->setChecked(false);
     }
 }
+
+void MainWindow::on_pushButton_texture_clicked()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Open Texture"), QString(),
+                                                      tr("Textures (*.ktx2 *.dds *.png *.jpg *.jpeg *.bmp);;All Files (*)"));
+    if (!path.isEmpty()) {
+        m_model->onCreateTexturedCube(path);
+    }
+}
+
+void MainWindow::on_pushButton_dynres_toggled(bool checked)
+{
+    for (SceneManager *scene : m_views) {
+        scene->setDynamicResolution(checked);
+    }
+}
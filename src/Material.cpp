@@ -2,7 +2,12 @@
 
 #include <QRandomGenerator>
 
-Material::Material()
+#include <atomic>
+
+static std::atomic<quint32> s_nextMaterialId { 1 };
+
+Material::Material() :
+    ID(s_nextMaterialId++)
 {
     std::uniform_real_distribution randColor(0.0, 1.0);
     for (int i = 0; i < MATERIAL_COLOR_COUNT; i++) {
@@ -10,3 +15,13 @@ Material::Material()
                              randColor(*QRandomGenerator::global()), 1.0f);
     }
 }
+
+bool Material::isTransparent() const
+{
+    for (int i = 0; i < MATERIAL_COLOR_COUNT; i++) {
+        if (Color[i].w() < 1.0f) {
+            return true;
+        }
+    }
+    return false;
+}
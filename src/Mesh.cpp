@@ -1,9 +1,18 @@
 #include "Mesh.h"
 
+#include <atomic>
+
+static std::atomic<quint32> s_nextMeshId { 1 };
+
 Mesh::Mesh(const QVector<VerticeInfo> &vertices, const QVector<GLushort> &indices) :
     m_vertices(vertices),
-    m_indices(indices)
+    m_indices(indices),
+    m_boundingRadius(0.0f),
+    m_id(s_nextMeshId++)
 {
+    for (const auto &vertex : m_vertices) {
+        m_boundingRadius = qMax(m_boundingRadius, vertex.pos.length());
+    }
 }
 
 const QVector<VerticeInfo> &Mesh::getVertices()
@@ -15,3 +24,13 @@ const QVector<GLushort> &Mesh::getIndices()
 {
     return m_indices;
 }
+
+float Mesh::getBoundingRadius() const
+{
+    return m_boundingRadius;
+}
+
+quint32 Mesh::ID() const
+{
+    return m_id;
+}
@@ -0,0 +1,88 @@
+#include "Obb.h"
+
+#include <cmath>
+
+Obb Obb::fromTransformation(const QMatrix4x4 &transformation, const QVector3D &halfExtents)
+{
+    const float *m = transformation.constData();
+    Obb box;
+    box.Center = QVector3D(m[12], m[13], m[14]);
+    for (int axis = 0; axis < 3; axis++) {
+        const QVector3D column(m[axis * 4], m[axis * 4 + 1], m[axis * 4 + 2]);
+        const float length = column.length();
+        box.Axes[axis] = length > 0.0f ? column / length : QVector3D();
+        box.HalfExtents[axis] = halfExtents[axis] * length;
+    }
+    return box;
+}
+
+void Obb::bounds(QVector3D &min, QVector3D &max) const
+{
+    QVector3D extent;
+    for (int i = 0; i < 3; i++) {
+        extent[i] =
+            std::fabs(Axes[0][i]) * HalfExtents[0] + std::fabs(Axes[1][i]) * HalfExtents[1] + std::fabs(Axes[2][i]) * HalfExtents[2];
+    }
+    min = Center - extent;
+    max = Center + extent;
+}
+
+bool Obb::isFinite() const
+{
+    for (int i = 0; i < 3; i++) {
+        if (!std::isfinite(Center[i]) || !std::isfinite(HalfExtents[i]) || !std::isfinite(Axes[0][i]) || !std::isfinite(Axes[1][i]) ||
+            !std::isfinite(Axes[2][i]))
+            return false;
+    }
+    return true;
+}
+
+bool Obb::intersects(const Obb &other) const
+{
+    // Gottschalk's test as laid out in Real-Time Collision Detection 4.4.1, everything expressed in this box's frame
+    float r[3][3];
+    float absR[3][3];
+    // Parallel edges make the cross product axes degenerate, the epsilon keeps them from causing false separations
+    const float epsilon = 1e-6f;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            r[i][j] = QVector3D::dotProduct(Axes[i], other.Axes[j]);
+            absR[i][j] = std::fabs(r[i][j]) + epsilon;
+        }
+    }
+
+    const QVector3D offset = other.Center - Center;
+    const float t[3] = { QVector3D::dotProduct(offset, Axes[0]), QVector3D::dotProduct(offset, Axes[1]),
+                         QVector3D::dotProduct(offset, Axes[2]) };
+    const QVector3D &a = HalfExtents;
+    const QVector3D &b = other.HalfExtents;
+
+    // Axes of this box
+    for (int i = 0; i < 3; i++) {
+        const float rb = b[0] * absR[i][0] + b[1] * absR[i][1] + b[2] * absR[i][2];
+        if (std::fabs(t[i]) > a[i] + rb)
+            return false;
+    }
+
+    // Axes of the other box
+    for (int j = 0; j < 3; j++) {
+        const float ra = a[0] * absR[0][j] + a[1] * absR[1][j] + a[2] * absR[2][j];
+        if (std::fabs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) > ra + b[j])
+            return false;
+    }
+
+    // Cross products of one axis of each box
+    for (int i = 0; i < 3; i++) {
+        const int i1 = (i + 1) % 3;
+        const int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            const int j1 = (j + 1) % 3;
+            const int j2 = (j + 2) % 3;
+            const float ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+            const float rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+            if (std::fabs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb)
+                return false;
+        }
+    }
+    return true;
+}
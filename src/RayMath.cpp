@@ -0,0 +1,154 @@
+#include "RayMath.h"
+
+#include <QVector4D>
+
+#include <cmath>
+#include <utility>
+
+RayMath::Ray RayMath::screenRay(float x, float y, float width, float height, const QMatrix4x4 &inverseViewProjection)
+{
+    // The near plane maps to z = -1 in normalized device coordinates, the end point can be anywhere further in
+    const float ndcX = (x / width - 0.5f) * 2.0f;
+    const float ndcY = (y / height - 0.5f) * 2.0f;
+    QVector4D start = inverseViewProjection * QVector4D(ndcX, ndcY, -1.0f, 1.0f);
+    QVector4D end = inverseViewProjection * QVector4D(ndcX, ndcY, 0.0f, 1.0f);
+    start /= start.w();
+    end /= end.w();
+
+    Ray ray;
+    ray.Origin = start.toVector3D();
+    ray.Direction = (end - start).toVector3D().normalized();
+    return ray;
+}
+
+RayMath::Ray RayMath::screenRayReference(float x, float y, float width, float height, const QMatrix4x4 &projection,
+                                         const QMatrix4x4 &view)
+{
+    // The ray Start and End positions, in Normalized Device Coordinates
+    QVector4D lRayStart_NDC((x / width - 0.5f) * 2.0f, (y / height - 0.5f) * 2.0f, -1.0f, 1.0f);
+    QVector4D lRayEnd_NDC((x / width - 0.5f) * 2.0f, (y / height - 0.5f) * 2.0f, 0.0f, 1.0f);
+
+    // The Projection matrix goes from Camera Space to NDC.
+    // So inverse(ProjectionMatrix) goes from NDC to Camera Space.
+    QMatrix4x4 InverseProjectionMatrix = projection.inverted();
+
+    // The View Matrix goes from World Space to Camera Space.
+    // So inverse(ViewMatrix) goes from Camera Space to World Space.
+    QMatrix4x4 InverseViewMatrix = view.inverted();
+
+    QVector4D lRayStart_camera = InverseProjectionMatrix * lRayStart_NDC;
+    lRayStart_camera /= lRayStart_camera.w();
+    QVector4D lRayStart_world = InverseViewMatrix * lRayStart_camera;
+    lRayStart_world /= lRayStart_world.w();
+    QVector4D lRayEnd_camera = InverseProjectionMatrix * lRayEnd_NDC;
+    lRayEnd_camera /= lRayEnd_camera.w();
+    QVector4D lRayEnd_world = InverseViewMatrix * lRayEnd_camera;
+    lRayEnd_world /= lRayEnd_world.w();
+
+    Ray ray;
+    ray.Origin = lRayStart_world.toVector3D();
+    ray.Direction = QVector3D(lRayEnd_world - lRayStart_world).normalized();
+    return ray;
+}
+
+bool RayMath::intersectsCube(const Ray &ray, const QMatrix4x4 &transformation)
+{
+    // Intersection method from Real-Time Rendering and Essential Mathematics for Games.
+    // Columns 0-2 are the cube's axes and column 3 its center, stored column-major.
+    const float *m = transformation.constData();
+    const float deltaX = m[12] - ray.Origin.x();
+    const float deltaY = m[13] - ray.Origin.y();
+    const float deltaZ = m[14] - ray.Origin.z();
+
+    float tMin = 0.0f;
+    float tMax = 100000.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        const float *column = m + axis * 4;
+        // Distance of the center along the axis, and how fast the ray moves along it
+        const float e = column[0] * deltaX + column[1] * deltaY + column[2] * deltaZ;
+        const float f = column[0] * ray.Direction.x() + column[1] * ray.Direction.y() + column[2] * ray.Direction.z();
+
+        if (std::fabs(f) > 0.001f) {
+            // Distances to the two planes perpendicular to the axis, nearest first
+            float t1 = (e - 1.0f) / f;
+            float t2 = (e + 1.0f) / f;
+            if (t1 > t2) {
+                std::swap(t1, t2);
+            }
+            tMax = qMin(tMax, t2);
+            tMin = qMax(tMin, t1);
+            if (tMin > tMax)
+                return false;
+        } else if (-e - 1.0f > 0.0f || -e + 1.0f < 0.0f) {
+            // Almost parallel to the planes and outside of them
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RayMath::intersectsCubeReference(const Ray &ray, const QMatrix4x4 &transformation, double *tNear, double *tFar)
+{
+    const QMatrix4x4 toLocal = transformation.inverted();
+    const QVector3D origin = toLocal.map(ray.Origin);
+    const QVector3D direction = toLocal.mapVector(ray.Direction);
+
+    double nearest = 0.0;
+    double farthest = 100000.0;
+    for (int axis = 0; axis < 3; axis++) {
+        const double o = origin[axis];
+        const double d = direction[axis];
+        if (d == 0.0) {
+            if (o < -1.0 || o > 1.0) {
+                nearest = farthest + 1.0;
+                break;
+            }
+            continue;
+        }
+        double t1 = (-1.0 - o) / d;
+        double t2 = (1.0 - o) / d;
+        if (t1 > t2) {
+            std::swap(t1, t2);
+        }
+        nearest = qMax(nearest, t1);
+        farthest = qMin(farthest, t2);
+    }
+
+    if (tNear) {
+        *tNear = nearest;
+    }
+    if (tFar) {
+        *tFar = farthest;
+    }
+    return nearest <= farthest;
+}
+
+RayMath::CameraBasis RayMath::cameraBasis(const QVector3D &position, const QVector3D &lookAt, const QVector3D &worldUp)
+{
+    const QVector3D back = (position - lookAt).normalized();
+    CameraBasis basis;
+    basis.Right = QVector3D::crossProduct(worldUp, back).normalized();
+    basis.Up = QVector3D::crossProduct(back, basis.Right);
+
+    // The basis is orthonormal already, the view matrix is its transpose followed by the inverse translation
+    const QVector3D &right = basis.Right;
+    const QVector3D &up = basis.Up;
+    // clang-format off
+    basis.View = QMatrix4x4(right.x(), right.y(), right.z(), -QVector3D::dotProduct(right, position),
+                            up.x(),    up.y(),    up.z(),    -QVector3D::dotProduct(up, position),
+                            back.x(),  back.y(),  back.z(),  -QVector3D::dotProduct(back, position),
+                            0.0f,      0.0f,      0.0f,      1.0f);
+    // clang-format on
+    return basis;
+}
+
+RayMath::CameraBasis RayMath::cameraBasisReference(const QVector3D &position, const QVector3D &lookAt, const QVector3D &worldUp)
+{
+    QVector3D dir = (position - lookAt).normalized();
+    CameraBasis basis;
+    basis.Right = QVector3D::crossProduct(worldUp, dir).normalized();
+    basis.Up = QVector3D::crossProduct(dir, basis.Right).normalized();
+    basis.View.setToIdentity();
+    basis.View.lookAt(position, lookAt, basis.Up);
+    return basis;
+}
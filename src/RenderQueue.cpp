@@ -0,0 +1,104 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+static constexpr int PASS_BITS = 2;
+static constexpr int PROGRAM_BITS = 10;
+static constexpr int MESH_BITS = 14;
+static constexpr int MATERIAL_BITS = 14;
+static constexpr int DEPTH_BITS = 24;
+static_assert(PASS_BITS + PROGRAM_BITS + MESH_BITS + MATERIAL_BITS + DEPTH_BITS == 64);
+
+static constexpr quint64 field(quint64 value, int bits, int shift)
+{
+    return (value & ((quint64(1) << bits) - 1)) << shift;
+}
+
+RenderQueue::RenderQueue() :
+    m_nearZ(0.0f),
+    m_farZ(1.0f)
+{
+}
+
+void RenderQueue::setDepthRange(float nearZ, float farZ)
+{
+    m_nearZ = nearZ;
+    m_farZ = farZ;
+}
+
+void RenderQueue::clear()
+{
+    m_items.clear();
+}
+
+void RenderQueue::push(RenderPass pass, quint32 program, quint32 mesh, quint32 material, float viewDepth, Shape *shape)
+{
+    const quint32 depth = quantizeDepth(viewDepth);
+    quint64 key = field(quint64(pass), PASS_BITS, 64 - PASS_BITS);
+    if (pass == RenderPass::OPAQUE) {
+        key |= field(program, PROGRAM_BITS, MESH_BITS + MATERIAL_BITS + DEPTH_BITS);
+        key |= field(mesh, MESH_BITS, MATERIAL_BITS + DEPTH_BITS);
+        key |= field(material, MATERIAL_BITS, DEPTH_BITS);
+        key |= field(depth, DEPTH_BITS, 0);
+    } else {
+        const quint32 invertedDepth = ((1u << DEPTH_BITS) - 1) - depth;
+        key |= field(invertedDepth, DEPTH_BITS, PROGRAM_BITS + MESH_BITS + MATERIAL_BITS);
+        key |= field(program, PROGRAM_BITS, MESH_BITS + MATERIAL_BITS);
+        key |= field(mesh, MESH_BITS, MATERIAL_BITS);
+        key |= field(material, MATERIAL_BITS, 0);
+    }
+    m_items.push_back({ key, shape });
+}
+
+void RenderQueue::sort()
+{
+    // LSD radix sort on 8 bit digits, stable so equal keys keep submission order
+    const size_t count = m_items.size();
+    if (count < 2)
+        return;
+    m_scratch.resize(count);
+
+    DrawItem *src = m_items.data();
+    DrawItem *dst = m_scratch.data();
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256];
+        std::memset(histogram, 0, sizeof(histogram));
+        for (size_t i = 0; i < count; i++) {
+            histogram[(src[i].Key >> shift) & 0xFF]++;
+        }
+        // Every key has the same digit, nothing to reorder in this pass
+        if (histogram[(src[0].Key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (auto &bucket : histogram) {
+            const size_t bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[histogram[(src[i].Key >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != m_items.data()) {
+        m_items.swap(m_scratch);
+    }
+}
+
+const std::vector<DrawItem> &RenderQueue::items() const
+{
+    return m_items;
+}
+
+RenderPass RenderQueue::passOf(quint64 key)
+{
+    return RenderPass(key >> (64 - PASS_BITS));
+}
+
+quint32 RenderQueue::quantizeDepth(float viewDepth) const
+{
+    const float normalized = qBound(0.0f, (viewDepth - m_nearZ) / (m_farZ - m_nearZ), 1.0f);
+    return quint32(normalized * float((1u << DEPTH_BITS) - 1));
+}
@@ -0,0 +1,300 @@
+#include "RenderResources.h"
+#include "GLStateCache.h"
+#include "Mesh.h"
+#include "StaticBatcher.h"
+
+#include <QOpenGLContext>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+
+// Turns restarted triangle strips into a plain triangle list, for contexts without primitive restart
+static std::vector<GLuint> stripsToTriangles(const GLuint *indices, int count)
+{
+    std::vector<GLuint> triangles;
+    triangles.reserve(count * 3);
+    int stripStart = 0;
+    for (int i = 0; i < count; i++) {
+        if (indices[i] == STATIC_BATCH_RESTART_INDEX) {
+            stripStart = i + 1;
+            continue;
+        }
+        const int position = i - stripStart;
+        if (position < 2)
+            continue;
+        const GLuint a = indices[i - 2];
+        const GLuint b = indices[i - 1];
+        const GLuint c = indices[i];
+        // Degenerate joins still flip the winding of the triangles after them
+        if (a == b || b == c || a == c)
+            continue;
+        if (position % 2 == 0) {
+            triangles.insert(triangles.end(), { a, b, c });
+        } else {
+            triangles.insert(triangles.end(), { b, a, c });
+        }
+    }
+    return triangles;
+}
+
+static QMutex s_registryMutex;
+static std::unordered_map<QOpenGLContextGroup *, std::weak_ptr<RenderResources>> s_registry;
+
+std::shared_ptr<RenderResources> RenderResources::acquire(GLStateCache &state)
+{
+    QOpenGLContextGroup *group = QOpenGLContextGroup::currentContextGroup();
+    Q_ASSERT(group);
+
+    QMutexLocker locker(&s_registryMutex);
+    auto it = s_registry.find(group);
+    if (it != s_registry.end()) {
+        if (auto existing = it->second.lock()) {
+            return existing;
+        }
+    }
+
+    std::shared_ptr<RenderResources> resources(new RenderResources());
+    if (!resources->initialize(state)) {
+        return nullptr;
+    }
+    s_registry[group] = resources;
+    return resources;
+}
+
+RenderResources::RenderResources() :
+    m_axesBuffer(QOpenGLBuffer::VertexBuffer),
+    m_axesVertexCount(0),
+    m_primitiveRestart(false)
+{
+}
+
+RenderResources::~RenderResources()
+{
+    m_textures.destroy();
+    for (auto &mesh : m_meshes) {
+        mesh.second.VertexBuffer.destroy();
+        mesh.second.IndexBuffer.destroy();
+    }
+    for (auto &chunk : m_chunks) {
+        chunk.second.VertexBuffer.destroy();
+        chunk.second.IndexBuffer.destroy();
+    }
+    m_axesBuffer.destroy();
+}
+
+QOpenGLShaderProgram &RenderResources::program()
+{
+    return m_program;
+}
+
+const ShaderLocations &RenderResources::locations() const
+{
+    return m_locations;
+}
+
+QOpenGLShaderProgram &RenderResources::upscaleProgram()
+{
+    return m_upscaleProgram;
+}
+
+const UpscaleLocations &RenderResources::upscaleLocations() const
+{
+    return m_upscaleLocations;
+}
+
+TextureStreamer &RenderResources::textures()
+{
+    return m_textures;
+}
+
+const QOpenGLBuffer &RenderResources::axesBuffer() const
+{
+    return m_axesBuffer;
+}
+
+int RenderResources::axesVertexCount() const
+{
+    return m_axesVertexCount;
+}
+
+const GpuMesh &RenderResources::meshBuffers(const std::shared_ptr<Mesh> &mesh, GLStateCache &state)
+{
+    auto it = m_meshes.find(mesh->ID());
+    if (it != m_meshes.end()) {
+        return it->second;
+    }
+
+    GpuMesh &gpu = m_meshes[mesh->ID()];
+    gpu.Source = mesh;
+    const auto &vertices = mesh->getVertices();
+    const auto &indices = mesh->getIndices();
+
+    gpu.VertexBuffer.create();
+    state.bindBuffer(GL_ARRAY_BUFFER, gpu.VertexBuffer.bufferId());
+    gpu.VertexBuffer.allocate(vertices.data(), (int)vertices.size() * sizeof(VerticeInfo));
+
+    gpu.IndexBuffer.create();
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.IndexBuffer.bufferId());
+    gpu.IndexBuffer.allocate(indices.data(), (int)indices.size() * sizeof(GLushort));
+    gpu.IndexCount = indices.size();
+    return gpu;
+}
+
+const GpuChunk &RenderResources::chunkBuffers(const std::shared_ptr<StaticChunk> &chunk, GLStateCache &state)
+{
+    GpuChunk &gpu = m_chunks[chunk->ID];
+    if (!gpu.VertexBuffer.isCreated()) {
+        gpu.Source = chunk;
+        gpu.Mode = m_primitiveRestart ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+        gpu.VertexBuffer.create();
+        gpu.IndexBuffer.create();
+    }
+    if (gpu.Generation != chunk->Generation || gpu.VertexCount != (int)chunk->Vertices.size() ||
+        gpu.SourceIndexCount != (int)chunk->Indices.size()) {
+        uploadChunk(gpu, *chunk, state);
+    }
+    return gpu;
+}
+
+void RenderResources::uploadChunk(GpuChunk &gpu, const StaticChunk &chunk, GLStateCache &state)
+{
+    // Appends within a generation go into the spare capacity, anything else uploads the whole chunk
+    const bool append = gpu.Generation == chunk.Generation && gpu.VertexCount > 0;
+    const int firstVertex = append ? gpu.VertexCount : 0;
+    const int firstIndex = append ? gpu.SourceIndexCount : 0;
+
+    const GLuint *indices = chunk.Indices.data() + firstIndex;
+    int indexCount = chunk.Indices.size() - firstIndex;
+    std::vector<GLuint> triangles;
+    if (!m_primitiveRestart) {
+        triangles = stripsToTriangles(indices, indexCount);
+        indices = triangles.data();
+        indexCount = triangles.size();
+    }
+
+    const int vertexOffset = firstVertex * sizeof(VerticeInfo);
+    const int vertexBytes = (chunk.Vertices.size() - firstVertex) * sizeof(VerticeInfo);
+    const int indexOffset = (append ? gpu.IndexCount : 0) * sizeof(GLuint);
+    const int indexBytes = indexCount * sizeof(GLuint);
+    if (append && (vertexOffset + vertexBytes > gpu.VertexCapacity || indexOffset + indexBytes > gpu.IndexCapacity)) {
+        // Out of room, reallocating drops the old contents so everything goes up again
+        gpu.VertexCount = 0;
+        uploadChunk(gpu, chunk, state);
+        return;
+    }
+
+    state.bindBuffer(GL_ARRAY_BUFFER, gpu.VertexBuffer.bufferId());
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.IndexBuffer.bufferId());
+    if (!append) {
+        // Leave room to grow, chunks fill up one shape at a time while a scene is being built
+        gpu.VertexCapacity = vertexBytes * 2;
+        gpu.IndexCapacity = indexBytes * 2;
+        gpu.VertexBuffer.allocate(gpu.VertexCapacity);
+        gpu.IndexBuffer.allocate(gpu.IndexCapacity);
+        gpu.IndexCount = 0;
+    }
+    gpu.VertexBuffer.write(vertexOffset, chunk.Vertices.data() + firstVertex, vertexBytes);
+    gpu.IndexBuffer.write(indexOffset, indices, indexBytes);
+
+    gpu.Generation = chunk.Generation;
+    gpu.VertexCount = chunk.Vertices.size();
+    gpu.SourceIndexCount = chunk.Indices.size();
+    gpu.IndexCount += indexCount;
+}
+
+void RenderResources::releaseUnusedBuffers()
+{
+    for (auto it = m_meshes.begin(); it != m_meshes.end();) {
+        if (it->second.Source.expired()) {
+            it->second.VertexBuffer.destroy();
+            it->second.IndexBuffer.destroy();
+            it = m_meshes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        if (it->second.Source.expired()) {
+            it->second.VertexBuffer.destroy();
+            it->second.IndexBuffer.destroy();
+            it = m_chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool RenderResources::primitiveRestart() const
+{
+    return m_primitiveRestart;
+}
+
+bool RenderResources::initialize(GLStateCache &state)
+{
+    // Compile vertex shader
+    if (!m_program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/vertex.glsl")) {
+        qDebug() << "RenderResources::initialize: Failed to compile vertex shader!";
+        return false;
+    }
+
+    // Compile fragment shader
+    if (!m_program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/fragment.glsl")) {
+        qDebug() << "RenderResources::initialize: Failed to compile fragment shader!";
+        return false;
+    }
+
+    // Link shader pipeline
+    if (!m_program.link()) {
+        qDebug() << "RenderResources::initialize: Failed to link shaders!";
+        return false;
+    }
+
+    // Look up attribute and uniform locations once instead of per draw
+    m_locations.Position = m_program.attributeLocation("a_position");
+    Q_ASSERT(m_locations.Position != -1);
+    m_locations.Color = m_program.attributeLocation("a_color");
+    Q_ASSERT(m_locations.Color != -1);
+    m_locations.Texcoord = m_program.attributeLocation("a_texcoord");
+    Q_ASSERT(m_locations.Texcoord != -1);
+    m_locations.Proj = m_program.uniformLocation("u_proj");
+    m_locations.View = m_program.uniformLocation("u_view");
+    m_locations.Trans = m_program.uniformLocation("u_trans");
+    m_locations.Texture = m_program.uniformLocation("u_texture");
+
+    if (!m_upscaleProgram.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/upscale_vertex.glsl") ||
+        !m_upscaleProgram.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/upscale_fragment.glsl")) {
+        qDebug() << "RenderResources::initialize: Failed to compile upscale shaders!";
+        return false;
+    }
+    if (!m_upscaleProgram.link()) {
+        qDebug() << "RenderResources::initialize: Failed to link upscale shaders!";
+        return false;
+    }
+    m_upscaleLocations.Texture = m_upscaleProgram.uniformLocation("u_texture");
+    m_upscaleLocations.TextureSize = m_upscaleProgram.uniformLocation("u_textureSize");
+    m_upscaleLocations.SourceScale = m_upscaleProgram.uniformLocation("u_sourceScale");
+
+    m_textures.initialize(state);
+
+    // A fixed restart index needs GL 4.3 or ES 3.0, older contexts draw static chunks as triangle lists
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    const QSurfaceFormat format = context->format();
+    const bool gl43 = format.majorVersion() > 4 || (format.majorVersion() == 4 && format.minorVersion() >= 3);
+    m_primitiveRestart = context->isOpenGLES() ? format.majorVersion() >= 3 : (gl43 || context->hasExtension("GL_ARB_ES3_compatibility"));
+
+    // x-y-z axes drawn from the center of the selected shape
+    static const QVector<VerticeInfo> axes = { { QVector3D(0.0f, 0.0f, 0.0f), QVector4D(1.0f, 0.0f, 0.0f, 1.0f) },
+                                               { QVector3D(6.0f, 0.0f, 0.0f), QVector4D(1.0f, 0.0f, 0.0f, 1.0f) },
+                                               { QVector3D(0.0f, 0.0f, 0.0f), QVector4D(0.0f, 1.0f, 0.0f, 1.0f) },
+                                               { QVector3D(0.0f, 6.0f, 0.0f), QVector4D(0.0f, 1.0f, 0.0f, 1.0f) },
+                                               { QVector3D(0.0f, 0.0f, 0.0f), QVector4D(0.0f, 0.0f, 1.0f, 1.0f) },
+                                               { QVector3D(0.0f, 0.0f, 6.0f), QVector4D(0.0f, 0.0f, 1.0f, 1.0f) } };
+    if (!m_axesBuffer.create()) {
+        qDebug() << "RenderResources::initialize: Failed to create buffers!";
+        return false;
+    }
+    state.bindBuffer(GL_ARRAY_BUFFER, m_axesBuffer.bufferId());
+    m_axesBuffer.allocate(axes.data(), (int)axes.size() * sizeof(VerticeInfo));
+    m_axesVertexCount = axes.size();
+    return true;
+}
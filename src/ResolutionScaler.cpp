@@ -0,0 +1,80 @@
+#include "ResolutionScaler.h"
+
+#include <QtGlobal>
+
+#include <cmath>
+
+ResolutionScaler::ResolutionScaler() :
+    m_budget(16.6f),
+    m_scale(1.0f),
+    m_frameTime(0.0f),
+    m_fullCost(0.0f),
+    m_hasFrameTime(false)
+{
+}
+
+void ResolutionScaler::setBudget(float milliseconds)
+{
+    m_budget = qMax(milliseconds, 0.1f);
+}
+
+float ResolutionScaler::budget() const
+{
+    return m_budget;
+}
+
+void ResolutionScaler::reset()
+{
+    m_scale = 1.0f;
+    m_frameTime = 0.0f;
+    m_fullCost = 0.0f;
+    m_hasFrameTime = false;
+}
+
+bool ResolutionScaler::addFrameTime(float milliseconds)
+{
+    // Smooth out single slow frames, a hitch should not halve the resolution.
+    // The cost is tracked as if rendered at full size, so frames from before a scale change don't push it further.
+    const float fullCost = milliseconds / (m_scale * m_scale);
+    if (m_hasFrameTime) {
+        m_frameTime += m_smoothing * (milliseconds - m_frameTime);
+        m_fullCost += m_smoothing * (fullCost - m_fullCost);
+    } else {
+        m_frameTime = milliseconds;
+        m_fullCost = fullCost;
+        m_hasFrameTime = true;
+    }
+    if (m_fullCost <= 0.0f)
+        return false;
+
+    const float expected = m_fullCost * m_scale * m_scale;
+    float scale = m_scale;
+    if (expected > m_budget) {
+        scale = qMax(std::sqrt(m_budget / m_fullCost), m_scale * m_max_step_down);
+    } else if (expected < m_budget * m_headroom) {
+        scale = qMin(std::sqrt(m_budget * m_headroom / m_fullCost), m_scale * m_max_step_up);
+    }
+    scale = qBound(m_min_scale, scale, 1.0f);
+
+    // Going up in tiny steps would keep requesting frames for no visible gain
+    if (scale > m_scale && scale - m_scale < 0.01f && scale != 1.0f)
+        return false;
+    const bool changed = scale != m_scale;
+    m_scale = scale;
+    return changed;
+}
+
+float ResolutionScaler::scale() const
+{
+    return m_scale;
+}
+
+float ResolutionScaler::frameTime() const
+{
+    return m_frameTime;
+}
+
+QSize ResolutionScaler::renderSize(const QSize &fullSize) const
+{
+    return QSize(qMax(1, qRound(fullSize.width() * m_scale)), qMax(1, qRound(fullSize.height() * m_scale)));
+}
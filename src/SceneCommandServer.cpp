@@ -0,0 +1,268 @@
+#include "SceneCommandServer.h"
+#include "SceneModel.h"
+#include "Shape.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDebug>
+
+using SceneProtocol::Command;
+using SceneProtocol::MessageType;
+
+// Batches in flight between the socket thread and the GUI thread, each one holds a whole socket read
+static const size_t s_queueCapacity = 256;
+// Qt reads ahead of readAll() up to this much per socket, beyond it data stays in the kernel and the sender blocks
+static const qint64 s_socketReadBufferSize = 1 << 20;
+
+SceneCommandReceiver::SceneCommandReceiver(SpscQueue<CommandBatch> &queue, std::atomic<bool> &notified) :
+    m_queue(queue),
+    m_notified(notified),
+    m_server(new QLocalServer(this)),
+    m_nextClient(1),
+    m_retryTimer(new QTimer(this))
+{
+    m_retryTimer->setInterval(1);
+    connect(m_server, &QLocalServer::newConnection, this, &SceneCommandReceiver::onNewConnection);
+    connect(m_retryTimer, &QTimer::timeout, this, &SceneCommandReceiver::retryStalled);
+}
+
+bool SceneCommandReceiver::listen(const QString &name)
+{
+    // A crashed instance may have left its socket file behind
+    QLocalServer::removeServer(name);
+    if (!m_server->listen(name)) {
+        qDebug() << "SceneCommandReceiver::listen: Failed to listen on" << name << ":" << m_server->errorString();
+        return false;
+    }
+    qDebug() << "Scene commands accepted on" << m_server->fullServerName();
+    return true;
+}
+
+void SceneCommandReceiver::sendFences(const std::vector<Fence> &fences)
+{
+    for (const auto &fence : fences) {
+        auto it = m_clients.find(fence.first);
+        if (it == m_clients.end())
+            continue;
+        QByteArray message;
+        SceneProtocol::appendFenceMessage(message, fence.second);
+        it->second.Socket->write(message);
+    }
+}
+
+void SceneCommandReceiver::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        const quint32 id = m_nextClient++;
+        // Without a limit Qt keeps pulling data into its own buffer while readClient() is stalled
+        socket->setReadBufferSize(s_socketReadBufferSize);
+        m_clients[id] = { socket, QByteArray() };
+        connect(socket, &QLocalSocket::readyRead, this, [this, id]() { readClient(id); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, id]() { dropClient(id); });
+        readClient(id);
+    }
+}
+
+void SceneCommandReceiver::readClient(quint32 id)
+{
+    // Picked up again once the stalled batch made it into the queue
+    if (m_stalled)
+        return;
+    auto it = m_clients.find(id);
+    if (it == m_clients.end())
+        return;
+
+    Client &client = it->second;
+    client.Buffer.append(client.Socket->readAll());
+
+    CommandBatch batch = std::make_unique<std::vector<Command>>();
+    qsizetype offset = 0;
+    for (;;) {
+        qsizetype consumed = 0;
+        const auto result = SceneProtocol::decode(client.Buffer.constData() + offset, client.Buffer.size() - offset, id, *batch, consumed);
+        if (result == SceneProtocol::DecodeResult::INCOMPLETE)
+            break;
+        if (result == SceneProtocol::DecodeResult::INVALID) {
+            qDebug() << "SceneCommandReceiver::readClient: Invalid message, dropping client" << id;
+            // Nothing after a broken message can be decoded, abort() reports the disconnect right away
+            client.Buffer.clear();
+            client.Socket->abort();
+            removeClient(id);
+            return;
+        }
+        offset += consumed;
+    }
+    client.Buffer.remove(0, offset);
+    // Everything complete it sent is in the batch now, a trailing partial message can't be finished anymore
+    const bool closing = client.Closing;
+
+    if (!batch->empty()) {
+        submit(std::move(batch));
+    }
+    if (closing) {
+        removeClient(id);
+    }
+}
+
+void SceneCommandReceiver::dropClient(quint32 id)
+{
+    auto it = m_clients.find(id);
+    if (it == m_clients.end())
+        return;
+    // Edits sent right before closing still count. While stalled, retryStalled() reads and removes the client.
+    it->second.Closing = true;
+    readClient(id);
+}
+
+void SceneCommandReceiver::removeClient(quint32 id)
+{
+    auto it = m_clients.find(id);
+    if (it == m_clients.end())
+        return;
+    it->second.Socket->deleteLater();
+    m_clients.erase(it);
+}
+
+void SceneCommandReceiver::submit(CommandBatch batch)
+{
+    if (!m_queue.push(std::move(batch))) {
+        m_stalled = std::move(batch);
+        m_retryTimer->start();
+        return;
+    }
+    if (!m_notified.exchange(true)) {
+        emit commandsAvailable();
+    }
+}
+
+void SceneCommandReceiver::retryStalled()
+{
+    CommandBatch batch = std::move(m_stalled);
+    submit(std::move(batch));
+    if (m_stalled)
+        return;
+    m_retryTimer->stop();
+
+    // Catch up on everything that arrived while stalled, including clients that disconnected meanwhile
+    std::vector<quint32> ids;
+    ids.reserve(m_clients.size());
+    for (const auto &client : m_clients) {
+        ids.push_back(client.first);
+    }
+    for (quint32 id : ids) {
+        readClient(id);
+    }
+}
+
+SceneCommandServer::SceneCommandServer(SceneModel *model, QObject *parent) :
+    QObject(parent),
+    m_model(model),
+    m_queue(s_queueCapacity),
+    m_notified(false),
+    m_receiver(new SceneCommandReceiver(m_queue, m_notified)),
+    m_frameInFlight(false)
+{
+    m_thread.setObjectName("SceneCommandReceiver");
+    m_receiver->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_receiver, &QObject::deleteLater);
+    connect(m_receiver, &SceneCommandReceiver::commandsAvailable, this, &SceneCommandServer::onCommandsAvailable);
+    m_thread.start();
+}
+
+SceneCommandServer::~SceneCommandServer()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool SceneCommandServer::listen(const QString &name)
+{
+    bool listening = false;
+    SceneCommandReceiver *receiver = m_receiver;
+    QMetaObject::invokeMethod(
+        m_receiver, [receiver, name, &listening]() { listening = receiver->listen(name); }, Qt::BlockingQueuedConnection);
+    return listening;
+}
+
+void SceneCommandServer::onFrameSwapped()
+{
+    m_frameInFlight = false;
+    if (!m_appliedFences.empty()) {
+        SceneCommandReceiver *receiver = m_receiver;
+        QMetaObject::invokeMethod(m_receiver, [receiver, fences = std::move(m_appliedFences)]() { receiver->sendFences(fences); });
+        m_appliedFences.clear();
+    }
+    if (!m_queue.empty()) {
+        applyPending();
+    }
+}
+
+void SceneCommandServer::onCommandsAvailable()
+{
+    // Otherwise the next presented frame picks them up
+    if (!m_frameInFlight) {
+        applyPending();
+    }
+}
+
+void SceneCommandServer::applyPending()
+{
+    // Re-arm before draining, a batch pushed from now on is either drained here or notifies again
+    m_notified = false;
+
+    bool applied = false;
+    bool cameraChanged = false;
+    Command camera = {};
+    CommandBatch batch;
+    while (m_queue.pop(batch)) {
+        for (const auto &command : *batch) {
+            switch (command.Type) {
+            case MessageType::CREATE: {
+                if (m_shapes.find(command.Id) != m_shapes.end())
+                    break;
+                Shape *shape = m_model->createCube(QString("remote-%1").arg(command.Id), command.Position);
+                if (shape) {
+                    m_shapes[command.Id] = shape;
+                }
+                break;
+            }
+            case MessageType::REMOVE: {
+                auto it = m_shapes.find(command.Id);
+                if (it == m_shapes.end())
+                    break;
+                m_model->removeShape(it->second->ID());
+                m_shapes.erase(it);
+                break;
+            }
+            case MessageType::TRANSFORM: {
+                auto it = m_shapes.find(command.Id);
+                if (it == m_shapes.end())
+                    break;
+                QMatrix4x4 &transformation = it->second->getTransformation();
+                transformation.setToIdentity();
+                transformation.translate(command.Position);
+                transformation.rotate(command.Rotation.normalized());
+                m_model->updateShape(it->second);
+                break;
+            }
+            case MessageType::CAMERA:
+                // Only the last camera of a frame matters
+                camera = command;
+                cameraChanged = true;
+                break;
+            case MessageType::FENCE:
+                m_appliedFences.push_back({ command.Client, command.Token });
+                break;
+            }
+        }
+        applied = true;
+    }
+
+    if (!applied)
+        return;
+    if (cameraChanged) {
+        emit cameraRequested(camera.Position, camera.LookAt, camera.Fov);
+    }
+    m_frameInFlight = true;
+    m_model->markChanged();
+}
@@ -2,145 +2,138 @@
 #include "ui_SceneManager.h"
 
 #include <QOpenGLContext>
-#include <QOpenGLFramebufferObject>
-#include <QRandomGenerator>
-#include <QUuid>
 #include <QVector3D>
-#include <QVector4D>
 #include <QDebug>
-#include "Cube.h"
+#include "RayMath.h"
+#include "SceneModel.h"
+#include "Shape.h"
 
 SceneManager::SceneManager(QWidget *parent) :
     QOpenGLWidget(parent),
     ui(new Ui::SceneManager),
-    m_arrayBuf(QOpenGLBuffer::VertexBuffer),
-    m_indexBuf(QOpenGLBuffer::IndexBuffer),
-    m_selected_shape(nullptr)
+    m_viewKind(ViewKind::PERSPECTIVE),
+    m_dynamicResolution(false),
+    m_streamsTextures(true)
 {
     ui->setupUi(this);
     connect(&m_logger, &QOpenGLDebugLogger::messageLogged, this, &SceneManager::PrintLoggedMessage);
-    m_camera.Position = QVector3D(-30.0f, 30.0f, 40.0f);
-    m_camera.LookAt = QVector3D(0.0f, 0.0f, 0.0f);
-    QVector3D dir = (m_camera.Position - m_camera.LookAt).normalized();
-    m_camera.Right = QVector3D::crossProduct(QVector3D(0.0f, 1.0f, 0.0f), dir).normalized();
-    m_camera.Up = QVector3D::crossProduct(dir, m_camera.Right).normalized();
     m_camera.FOV = m_default_fov;
+    m_camera.OrthoHalfHeight = m_default_ortho_half_height;
     m_camera.State = CameraState::NONE;
+    setViewKind(ViewKind::PERSPECTIVE);
 }
 
 SceneManager::~SceneManager()
 {
-    makeCurrent();
-    m_logger.stopLogging();
-    m_arrayBuf.destroy();
-    m_indexBuf.destroy();
-    m_program.release();
-    doneCurrent();
-    for (const auto &shape : m_shapes) {
-        if (shape.second) {
-            delete shape.second;
-        }
-    }
+    releaseGL();
     delete ui;
 }
 
-void SceneManager::renderAll()
+void SceneManager::setSceneModel(SceneModel *model)
 {
-    // Clear color and depth buffer
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    for (const auto &shape : m_shapes) {
-        Shape *cube = shape.second;
-        auto vertices = cube->getMesh()->getVertices();
-        auto indices = cube->getMesh()->getIndices();
-
-        // Update vertex and index buffers
-        m_arrayBuf.write(0, vertices.data(), (int)vertices.size() * sizeof(VerticeInfo));
-        m_indexBuf.write(0, indices.data(), (int)indices.size() * sizeof(GLushort));
-
-        // Model View Projection
-        static const QVector3D up(0.0f, 1.0f, 0.0f);
-        QVector3D dir = (m_camera.Position - m_camera.LookAt).normalized();
-        m_camera.Right = QVector3D::crossProduct(up, dir).normalized();
-        m_camera.Up = QVector3D::crossProduct(dir, m_camera.Right).normalized();
-        m_view.setToIdentity();
-        m_view.lookAt(m_camera.Position, m_camera.LookAt, m_camera.Up);
-
-        // Let GPU do the calculation of the final mvp
-        m_program.setUniformValue("u_proj", m_projection);
-        m_program.setUniformValue("u_view", m_view);
-        m_program.setUniformValue("u_trans", cube->getTransformation());
-
-        int offset = 0;
-        // Vertex positions
-        int vertexLocation = m_program.attributeLocation("a_position");
-        Q_ASSERT(vertexLocation != -1);
-        m_program.enableAttributeArray(vertexLocation);
-        m_program.setAttributeBuffer(vertexLocation, GL_FLOAT, 0, 3, sizeof(VerticeInfo));
-
-        offset += (int)sizeof(QVector3D);
-
-        // Colors for the surfaces
-        int colorLocation = m_program.attributeLocation("a_color");
-        Q_ASSERT(colorLocation != -1);
-        m_program.enableAttributeArray(colorLocation);
-        m_program.setAttributeBuffer(colorLocation, GL_FLOAT, offset, 4, sizeof(VerticeInfo));
-
-        // Draw the shape
-        glDrawElements(GL_TRIANGLE_STRIP, indices.size(), GL_UNSIGNED_SHORT, nullptr);
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
     }
+    m_model = model;
+    if (m_model) {
+        connect(m_model, &SceneModel::changed, this, [this]() { update(); });
+    }
+    update();
+}
 
-    if (m_selected_shape) {
-        // Draw x-y-z axes of the selected shape from its center
-        m_program.setUniformValue("u_trans", m_selected_shape->getTransformation());
+void SceneManager::setViewKind(ViewKind kind)
+{
+    m_viewKind = kind;
+    m_camera.LookAt = QVector3D(0.0f, 0.0f, 0.0f);
+    switch (kind) {
+    case ViewKind::PERSPECTIVE:
+        m_camera.Position = QVector3D(-30.0f, 30.0f, 40.0f);
+        m_camera.WorldUp = QVector3D(0.0f, 1.0f, 0.0f);
+        break;
+    case ViewKind::TOP:
+        // Looking down the y axis, -z is up on screen
+        m_camera.Position = QVector3D(0.0f, 100.0f, 0.0f);
+        m_camera.WorldUp = QVector3D(0.0f, 0.0f, -1.0f);
+        break;
+    case ViewKind::FRONT:
+        m_camera.Position = QVector3D(0.0f, 0.0f, 100.0f);
+        m_camera.WorldUp = QVector3D(0.0f, 1.0f, 0.0f);
+        break;
+    case ViewKind::SIDE:
+        m_camera.Position = QVector3D(100.0f, 0.0f, 0.0f);
+        m_camera.WorldUp = QVector3D(0.0f, 1.0f, 0.0f);
+        break;
+    }
+    updateView();
+    updateProjection();
+    update();
+}
 
-        static const QVector<VerticeInfo> vertices = { { QVector3D(0.0f, 0.0f, 0.0f), QVector4D(1.0f, 0.0f, 0.0f, 1.0f) },
-                                                       { QVector3D(6.0f, 0.0f, 0.0f), QVector4D(1.0f, 0.0f, 0.0f, 1.0f) },
-                                                       { QVector3D(0.0f, 0.0f, 0.0f), QVector4D(0.0f, 1.0f, 0.0f, 1.0f) },
-                                                       { QVector3D(0.0f, 6.0f, 0.0f), QVector4D(0.0f, 1.0f, 0.0f, 1.0f) },
-                                                       { QVector3D(0.0f, 0.0f, 0.0f), QVector4D(0.0f, 0.0f, 1.0f, 1.0f) },
-                                                       { QVector3D(0.0f, 0.0f, 6.0f), QVector4D(0.0f, 0.0f, 1.0f, 1.0f) } };
+void SceneManager::setCamera(const QVector3D &position, const QVector3D &lookAt, float fov)
+{
+    m_camera.Position = position;
+    m_camera.LookAt = lookAt;
+    m_camera.FOV = qBound(2.0f, fov, 178.0f);
+    updateView();
+    updateProjection();
+    update();
+}
 
-        m_arrayBuf.write(0, vertices.data(), (int)vertices.size() * sizeof(VerticeInfo));
+void SceneManager::setDynamicResolution(bool enabled)
+{
+    m_dynamicResolution = enabled;
+    m_scaler.reset();
+    update();
+}
 
-        glDrawArrays(GL_LINES, 0, vertices.size());
-    }
+void SceneManager::setFrameBudget(float milliseconds)
+{
+    m_scaler.setBudget(milliseconds);
+    update();
 }
 
-Shape *SceneManager::pickShape(int mouse_x, int mouse_y)
+void SceneManager::setStreamsTextures(bool enabled)
 {
-    QVector3D ray_origin;
-    QVector3D ray_direction;
-    CastRayFromScreenToWorld(mouse_x, this->height() - mouse_y, ray_origin, ray_direction);
+    m_streamsTextures = enabled;
+    update();
+}
 
-    for (const auto &shape : m_shapes) {
-        if (RayIntersectionTest(shape.second, ray_origin, ray_direction)) {
-            return shape.second;
-        }
+void SceneManager::updateProjection()
+{
+    const float aspect = (float)qMax(1, this->width()) / (float)qMax(1, this->height());
+    m_projection.setToIdentity();
+    if (m_viewKind == ViewKind::PERSPECTIVE) {
+        m_projection.perspective(m_camera.FOV, aspect, m_near_z, m_far_z);
+    } else {
+        const float halfHeight = m_camera.OrthoHalfHeight;
+        m_projection.ortho(-halfHeight * aspect, halfHeight * aspect, -halfHeight, halfHeight, m_near_z, m_far_z);
     }
-
-    return nullptr;
+    m_inverseViewProjection = (m_projection * m_view).inverted();
 }
 
-Shape *SceneManager::createShape(const QString &type, QString &id)
+void SceneManager::updateView()
 {
-    if (type == "Cube") {
-        id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        Shape *newShape = new Cube(id);
-        return newShape;
-    }
-    return nullptr;
+    // Camera basis and view matrix are the same for every shape
+    const RayMath::CameraBasis basis = RayMath::cameraBasis(m_camera.Position, m_camera.LookAt, m_camera.WorldUp);
+    m_camera.Right = basis.Right;
+    m_camera.Up = basis.Up;
+    m_view = basis.View;
+    m_inverseViewProjection = (m_projection * m_view).inverted();
 }
 
-void SceneManager::onCreateCube()
+Shape *SceneManager::pickShape(int mouse_x, int mouse_y)
 {
-    QString id;
-    Shape *newShape = createShape("Cube", id);
-    if (newShape) {
-        m_shapes[id] = newShape;
-        qDebug() << " new cube id = " << id;
+    if (!m_model)
+        return nullptr;
+
+    const RayMath::Ray ray = RayMath::screenRay(mouse_x, this->height() - mouse_y, this->width(), this->height(), m_inverseViewProjection);
+    for (const auto &shape : m_model->shapes()) {
+        if (RayMath::intersectsCube(ray, shape.second->getTransformation())) {
+            return shape.second;
+        }
     }
-    update();
+
+    return nullptr;
 }
 
 void SceneManager::onPanToggled(bool checked)
@@ -178,15 +171,14 @@ void SceneManager::keyPressEvent(QKeyEvent *event)
 
 void SceneManager::mousePressEvent(QMouseEvent *e)
 {
+    setFocus();
+    if (!m_model)
+        return;
+
+    // The selection lives in the model, every view repaints with it
     Shape *cube = pickShape(e->pos().x(), e->pos().y());
-    if (!cube) {
-        m_selected_shape = nullptr;
-        emit UpdateStatusLabel("Nothing is selected.");
-    } else {
-        m_selected_shape = cube;
-        emit UpdateStatusLabel("Cube is selected.");
-    }
-    update();
+    m_model->setSelectedShape(cube);
+    emit UpdateStatusLabel(cube ? "Cube is selected." : "Nothing is selected.");
 }
 
 void SceneManager::wheelEvent(QWheelEvent *event)
@@ -200,77 +192,76 @@ void SceneManager::wheelEvent(QWheelEvent *event)
     }
 }
 
-void SceneManager::InitalizeShaders()
+void SceneManager::initializeGL()
 {
-    // Compile vertex shader
-    if (!m_program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/vertex.glsl")) {
-        qDebug() << "SceneManager::InitalizeShaders: Failed to compile vertex shader!";
-        close();
-    }
+    qDebug() << Q_FUNC_INFO << ": initializing GL...";
+    qDebug() << "OpenGL Version: " << QOpenGLContext::currentContext()->format().majorVersion()
+             << QOpenGLContext::currentContext()->format().minorVersion();
 
-    // Compile fragment shader
-    if (!m_program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/fragment.glsl")) {
-        qDebug() << "SceneManager::InitalizeShaders: Failed to compile fragment shader!";
-        close();
-    }
+    // The widget's context can be replaced, e.g. on re-parenting, give back the shared resources with it
+    connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, &SceneManager::releaseGL, Qt::UniqueConnection);
 
-    // Link shader pipeline
-    if (!m_program.link()) {
-        qDebug() << "SceneManager::InitalizeShaders: Failed to link shaders!";
-        close();
-    }
+    context()->functions()->glEnable(GL_DEBUG_OUTPUT);
+    m_logger.initialize();
+    m_logger.startLogging();
 
-    // Bind shader pipeline for use
-    if (!m_program.bind()) {
-        qDebug() << "SceneManager::InitalizeShaders: Failed to bind shader program!";
+    if (!m_renderer.initialize()) {
+        qDebug() << "SceneManager::initializeGL: Failed to initialize renderer!";
         close();
+        return;
     }
+    m_frameTimer.initialize();
+
+    // Emitted from a loader thread, the queued call lands on the GUI thread
+    connect(&m_renderer.textures(), &TextureStreamer::textureLoaded, this, qOverload<>(&SceneManager::update), Qt::UniqueConnection);
+    // Whichever view uploads, all of them sample the new mips
+    connect(&m_renderer.textures(), &TextureStreamer::texturesUploaded, this, qOverload<>(&SceneManager::update), Qt::UniqueConnection);
 }
 
-void SceneManager::InitalizeBuffers()
+void SceneManager::resizeGL(int w, int h)
 {
-    if (!m_arrayBuf.create())
-        close();
-    if (!m_arrayBuf.bind())
-        close();
-    if (!m_indexBuf.create())
-        close();
-    if (!m_indexBuf.bind())
-        close();
-
-    m_arrayBuf.allocate(nullptr, 24 * sizeof(VerticeInfo));
-    m_indexBuf.allocate(nullptr, 34 * sizeof(GLushort));
+    Q_UNUSED(w);
+    Q_UNUSED(h);
+    updateProjection();
 }
 
-void SceneManager::initializeGL()
+void SceneManager::paintGL()
 {
-    qDebug() << Q_FUNC_INFO << ": initializing GL...";
-    initializeOpenGLFunctions();
-    qDebug() << "OpenGL Version: " << QOpenGLContext::currentContext()->format().majorVersion()
-             << QOpenGLContext::currentContext()->format().minorVersion();
-
-    glEnable(GL_DEBUG_OUTPUT);
-    m_logger.initialize();
-    m_logger.startLogging();
-
-    InitalizeShaders();
-    InitalizeBuffers();
-
-    // Enable depth buffer
-    glEnable(GL_DEPTH_TEST);
-    // Enable back face culling
-    glEnable(GL_CULL_FACE);
-
-    glClearColor(0.8f, 0.8f, 0.8f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (!m_model)
+        return;
 
-    m_projection.setToIdentity();
-    m_projection.perspective(m_camera.FOV, (float)this->width() / (float)this->height(), m_near_z, m_far_z);
+    // Make freshly loaded mips resident first, keep frames coming until the uploads are done.
+    // The other views repaint through texturesUploaded.
+    const bool uploading = m_streamsTextures && m_renderer.uploadPending();
+
+    const QSize outputSize = size() * devicePixelRatio();
+    const QSize renderSize = m_dynamicResolution ? m_scaler.renderSize(outputSize) : outputSize;
+    m_frameTimer.begin();
+    m_renderer.renderScaled(*m_model, m_projection, m_view, m_near_z, m_far_z, renderSize, outputSize, defaultFramebufferObject());
+    const float frameTime = m_frameTimer.end();
+
+    // A changed scale gets its own frame, otherwise the view would sit at the old one until the next edit
+    bool rescaled = false;
+    if (m_dynamicResolution) {
+        rescaled = m_scaler.addFrameTime(frameTime);
+        emit frameStatsChanged(m_scaler.scale(), m_scaler.frameTime());
+    } else {
+        emit frameStatsChanged(1.0f, frameTime);
+    }
+    if (uploading || rescaled) {
+        update();
+    }
 }
 
-void SceneManager::paintGL()
+void SceneManager::releaseGL()
 {
-    renderAll();
+    if (!context())
+        return;
+    makeCurrent();
+    m_logger.stopLogging();
+    m_frameTimer.release();
+    m_renderer.release();
+    doneCurrent();
 }
 
 void SceneManager::PanViewport(int key)
@@ -295,11 +286,29 @@ void SceneManager::PanViewport(int key)
     default:
         return;
     }
+    updateView();
     update();
 }
 
 void SceneManager::ZoomViewport(int key)
 {
+    if (m_viewKind != ViewKind::PERSPECTIVE) {
+        // Orthographic views zoom by shrinking or growing the visible area
+        switch (key) {
+        case Qt::Key_Up:
+            m_camera.OrthoHalfHeight = qMax(1.0f, m_camera.OrthoHalfHeight * 0.9f);
+            break;
+        case Qt::Key_Down:
+            m_camera.OrthoHalfHeight = qMin(m_far_z, m_camera.OrthoHalfHeight / 0.9f);
+            break;
+        default:
+            return;
+        }
+        updateProjection();
+        update();
+        return;
+    }
+
     switch (key) {
     case Qt::Key_Up:
         m_camera.FOV -= 2.0f;
@@ -317,13 +326,16 @@ void SceneManager::ZoomViewport(int key)
         return;
     }
     // Reset perspective projection
-    m_projection.setToIdentity();
-    m_projection.perspective(m_camera.FOV, (float)this->width() / (float)this->height(), m_near_z, m_far_z);
+    updateProjection();
     update();
 }
 
 void SceneManager::RotateViewport(int key)
 {
+    // Orthographic views stay aligned to their world axis
+    if (m_viewKind != ViewKind::PERSPECTIVE)
+        return;
+
     switch (key) {
     // Make sure up and down rotations wont flip the scene
     case Qt::Key_Up:
@@ -347,158 +359,10 @@ void SceneManager::RotateViewport(int key)
     default:
         return;
     }
+    updateView();
     update();
 }
 
-void SceneManager::CastRayFromScreenToWorld(int mouseX, int mouseY, QVector3D &out_origin, QVector3D &out_direction)
-{
-    // The ray Start and End positions, in Normalized Device Coordinates
-    QVector4D lRayStart_NDC(((float)mouseX / (float)this->width() - 0.5f) * 2.0f, ((float)mouseY / (float)this->height() - 0.5f) * 2.0f,
-                            -1.0,    // The near plane maps to Z=-1 in Normalized Device Coordinates
-                            1.0f);
-    QVector4D lRayEnd_NDC(((float)mouseX / (float)this->width() - 0.5f) * 2.0f, ((float)mouseY / (float)this->height() - 0.5f) * 2.0f, 0.0,
-                          1.0f);
-
-    // The Projection matrix goes from Camera Space to NDC.
-    // So inverse(ProjectionMatrix) goes from NDC to Camera Space.
-    QMatrix4x4 InverseProjectionMatrix = m_projection.inverted();
-
-    // The View Matrix goes from World Space to Camera Space.
-    // So inverse(ViewMatrix) goes from Camera Space to World Space.
-    QMatrix4x4 InverseViewMatrix = m_view.inverted();
-
-    QVector4D lRayStart_camera = InverseProjectionMatrix * lRayStart_NDC;
-    lRayStart_camera /= lRayStart_camera.w();
-    QVector4D lRayStart_world = InverseViewMatrix * lRayStart_camera;
-    lRayStart_world /= lRayStart_world.w();
-    QVector4D lRayEnd_camera = InverseProjectionMatrix * lRayEnd_NDC;
-    lRayEnd_camera /= lRayEnd_camera.w();
-    QVector4D lRayEnd_world = InverseViewMatrix * lRayEnd_camera;
-    lRayEnd_world /= lRayEnd_world.w();
-
-    QVector3D lRayDir_world(lRayEnd_world - lRayStart_world);
-    lRayDir_world = lRayDir_world.normalized();
-
-    out_origin = QVector3D(lRayStart_world);
-    out_direction = lRayDir_world.normalized();
-}
-
-bool SceneManager::RayIntersectionTest(Shape *shape, const QVector3D &ray_origin, const QVector3D &ray_direction)
-{
-    // Intersection method from Real-Time Rendering and Essential Mathematics for Games
-    float tMin = 0.0f;
-    float tMax = 100000.0f;
-
-    QVector3D OBBposition_worldspace(shape->getTransformation().column(3).x(), shape->getTransformation().column(3).y(),
-                                     shape->getTransformation().column(3).z());
-
-    QVector3D delta = OBBposition_worldspace - ray_origin;
-    static const QVector3D aabb_min(-1.0f, -1.0f, -1.0f);
-    static const QVector3D aabb_max(1.0f, 1.0f, 1.0f);
-
-    // Test intersection with the 2 planes perpendicular to the OBB's X axis
-    {
-        QVector3D xaxis(shape->getTransformation().column(0).x(), shape->getTransformation().column(0).y(),
-                        shape->getTransformation().column(0).z());
-        float e = QVector3D::dotProduct(xaxis, delta);
-        float f = QVector3D::dotProduct(ray_direction, xaxis);
-
-        if (fabs(f) > 0.001f) {    // Standard case
-
-            float t1 = (e + aabb_min.x()) / f;    // Intersection with the "left" plane
-            float t2 = (e + aabb_max.x()) / f;    // Intersection with the "right" plane
-            // t1 and t2 now contain distances betwen ray origin and ray-plane intersections
-
-            // We want t1 to represent the nearest intersection,
-            // so if it's not the case, invert t1 and t2
-            if (t1 > t2) {
-                float w = t1;
-                t1 = t2;
-                t2 = w;    // swap t1 and t2
-            }
-
-            // tMax is the nearest "far" intersection (amongst the X,Y and Z planes pairs)
-            if (t2 < tMax)
-                tMax = t2;
-            // tMin is the farthest "near" intersection (amongst the X,Y and Z planes pairs)
-            if (t1 > tMin)
-                tMin = t1;
-
-            // If "far" is closer than "near", then there is NO intersection.
-            if (tMax < tMin)
-                return false;
-
-        } else {    // Rare case : the ray is almost parallel to the planes, so they don't have any "intersection"
-            if (-e + aabb_min.x() > 0.0f || -e + aabb_max.x() < 0.0f)
-                return false;
-        }
-    }
-
-    // Test intersection with the 2 planes perpendicular to the OBB's Y axis
-    {
-        QVector3D yaxis(shape->getTransformation().column(1).x(), shape->getTransformation().column(1).y(),
-                        shape->getTransformation().column(1).z());
-        float e = QVector3D::dotProduct(yaxis, delta);
-        float f = QVector3D::dotProduct(ray_direction, yaxis);
-
-        if (fabs(f) > 0.001f) {
-
-            float t1 = (e + aabb_min.y()) / f;
-            float t2 = (e + aabb_max.y()) / f;
-
-            if (t1 > t2) {
-                float w = t1;
-                t1 = t2;
-                t2 = w;
-            }
-
-            if (t2 < tMax)
-                tMax = t2;
-            if (t1 > tMin)
-                tMin = t1;
-            if (tMin > tMax)
-                return false;
-
-        } else {
-            if (-e + aabb_min.y() > 0.0f || -e + aabb_max.y() < 0.0f)
-                return false;
-        }
-    }
-
-    // Test intersection with the 2 planes perpendicular to the OBB's Z axis
-    {
-        QVector3D zaxis(shape->getTransformation().column(2).x(), shape->getTransformation().column(2).y(),
-                        shape->getTransformation().column(2).z());
-        float e = QVector3D::dotProduct(zaxis, delta);
-        float f = QVector3D::dotProduct(ray_direction, zaxis);
-
-        if (fabs(f) > 0.001f) {
-
-            float t1 = (e + aabb_min.z()) / f;
-            float t2 = (e + aabb_max.z()) / f;
-
-            if (t1 > t2) {
-                float w = t1;
-                t1 = t2;
-                t2 = w;
-            }
-
-            if (t2 < tMax)
-                tMax = t2;
-            if (t1 > tMin)
-                tMin = t1;
-            if (tMin > tMax)
-                return false;
-
-        } else {
-            if (-e + aabb_min.z() > 0.0f || -e + aabb_max.z() < 0.0f)
-                return false;
-        }
-    }
-
-    return true;
-}
-
 void SceneManager::PrintLoggedMessage(const QOpenGLDebugMessage &debugMessage)
 {
     qDebug() << debugMessage.message();
@@ -0,0 +1,210 @@
+#include "SceneModel.h"
+#include "Cube.h"
+
+#include <QRandomGenerator>
+#include <QUuid>
+#include <QDebug>
+
+#include <random>
+
+// Placement tries this many spots before it widens the area
+static const int s_placementAttempts = 16;
+static const float s_spawnGrowth = 1.25f;
+// Past these a shape is placed overlapping, float positions would lose too much precision further out
+static const int s_maxPlacementAttempts = 1024;
+static const float s_maxSpawnExtent = 4096.0f;
+
+SceneModel::SceneModel(QObject *parent) :
+    QObject(parent),
+    m_selected_shape(nullptr),
+    m_spawnExtent(10.0f)
+{
+}
+
+SceneModel::~SceneModel()
+{
+    for (const auto &shape : m_shapes) {
+        if (shape.second) {
+            delete shape.second;
+        }
+    }
+}
+
+const std::unordered_map<QString, Shape *> &SceneModel::shapes() const
+{
+    return m_shapes;
+}
+
+Shape *SceneModel::selectedShape() const
+{
+    return m_selected_shape;
+}
+
+void SceneModel::setSelectedShape(Shape *shape)
+{
+    m_selected_shape = shape;
+    emit changed();
+}
+
+void SceneModel::createCubes(int count)
+{
+    m_shapes.reserve(m_shapes.size() + count);
+    for (int i = 0; i < count; i++) {
+        QString id;
+        Shape *newShape = createShape("Cube", id);
+        if (newShape) {
+            insertShape(id, newShape);
+        }
+    }
+    emit changed();
+}
+
+Shape *SceneModel::createCube(const QString &id, const QVector3D &position)
+{
+    if (m_shapes.find(id) != m_shapes.end())
+        return nullptr;
+
+    Shape *newShape = new Cube(id);
+    newShape->getTransformation().setToIdentity();
+    newShape->getTransformation().translate(position);
+    insertShape(id, newShape);
+    return newShape;
+}
+
+bool SceneModel::removeShape(const QString &id)
+{
+    auto it = m_shapes.find(id);
+    if (it == m_shapes.end())
+        return false;
+
+    if (m_selected_shape == it->second) {
+        m_selected_shape = nullptr;
+    }
+    m_staticBatches.remove(it->second);
+    auto proxy = m_proxies.find(it->second);
+    if (proxy != m_proxies.end()) {
+        m_collisions.remove(proxy->second);
+        m_proxies.erase(proxy);
+    }
+    delete it->second;
+    m_shapes.erase(it);
+    return true;
+}
+
+void SceneModel::updateShape(Shape *shape)
+{
+    auto proxy = m_proxies.find(shape);
+    if (proxy != m_proxies.end()) {
+        m_collisions.update(proxy->second, Obb::fromTransformation(shape->getTransformation()));
+    }
+}
+
+void SceneModel::markChanged()
+{
+    emit changed();
+}
+
+void SceneModel::setStaticBatching(bool enabled)
+{
+    if (enabled == m_staticBatches.isEnabled())
+        return;
+
+    m_staticBatches.setEnabled(enabled);
+    for (const auto &shape : m_shapes) {
+        m_staticBatches.add(shape.second);
+    }
+    emit changed();
+}
+
+bool SceneModel::staticBatching() const
+{
+    return m_staticBatches.isEnabled();
+}
+
+const StaticBatcher &SceneModel::staticBatches() const
+{
+    return m_staticBatches;
+}
+
+std::vector<std::pair<Shape *, Shape *>> SceneModel::overlappingPairs()
+{
+    std::vector<std::pair<CollisionWorld::ProxyId, CollisionWorld::ProxyId>> pairs;
+    m_collisions.overlappingPairs(pairs);
+
+    std::vector<std::pair<Shape *, Shape *>> shapes;
+    shapes.reserve(pairs.size());
+    for (const auto &pair : pairs) {
+        shapes.emplace_back(m_collisions.item(pair.first), m_collisions.item(pair.second));
+    }
+    return shapes;
+}
+
+bool SceneModel::overlaps(const QMatrix4x4 &transformation, Shape *ignore) const
+{
+    auto proxy = m_proxies.find(ignore);
+    return m_collisions.overlapsAny(Obb::fromTransformation(transformation),
+                                    proxy != m_proxies.end() ? proxy->second : CollisionWorld::InvalidProxy);
+}
+
+void SceneModel::onCreateCube()
+{
+    QString id;
+    Shape *newShape = createShape("Cube", id);
+    if (newShape) {
+        insertShape(id, newShape);
+        qDebug() << " new cube id = " << id;
+    }
+    emit changed();
+}
+
+void SceneModel::onCreateTexturedCube(const QString &texturePath)
+{
+    QString id;
+    Shape *newShape = createShape("Cube", id);
+    if (newShape) {
+        newShape->getMaterial()->Texture = texturePath;
+        insertShape(id, newShape);
+        qDebug() << " new textured cube id = " << id << " texture = " << texturePath;
+    }
+    emit changed();
+}
+
+Shape *SceneModel::createShape(const QString &type, QString &id)
+{
+    if (type == "Cube") {
+        id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        Shape *newShape = new Cube(id);
+        // Nothing moves locally created shapes, only the ones streamed in through createCube() get transformed
+        newShape->setStatic(true);
+        placeShape(newShape);
+        return newShape;
+    }
+    return nullptr;
+}
+
+void SceneModel::insertShape(const QString &id, Shape *shape)
+{
+    m_shapes[id] = shape;
+    m_staticBatches.add(shape);
+    // Every shape is a cube so far, the unit box around the mesh is its exact bound
+    m_proxies[shape] = m_collisions.add(Obb::fromTransformation(shape->getTransformation()), shape);
+}
+
+void SceneModel::placeShape(Shape *shape)
+{
+    // Keep the random spot the shape came with if it is free, otherwise draw new ones until one is
+    QMatrix4x4 &transformation = shape->getTransformation();
+    for (int attempt = 1; overlaps(transformation); attempt++) {
+        if (attempt > s_maxPlacementAttempts) {
+            qDebug() << "SceneModel::placeShape: No free spot found for" << shape->ID() << ", placing it overlapping";
+            return;
+        }
+        if (attempt % s_placementAttempts == 0) {
+            m_spawnExtent = qMin(m_spawnExtent * s_spawnGrowth, s_maxSpawnExtent);
+        }
+        std::uniform_real_distribution rand(-m_spawnExtent, m_spawnExtent);
+        QVector3D position(rand(*QRandomGenerator::global()), rand(*QRandomGenerator::global()), rand(*QRandomGenerator::global()));
+        transformation.setToIdentity();
+        transformation.translate(position);
+    }
+}
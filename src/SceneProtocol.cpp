@@ -0,0 +1,157 @@
+#include "SceneProtocol.h"
+
+#include <QtEndian>
+#include <QtNumeric>
+
+using SceneProtocol::MessageType;
+
+template <typename T>
+static T readLittleEndian(const char *data, qsizetype offset)
+{
+    return qFromLittleEndian<T>(data + offset);
+}
+
+static QVector3D readVector(const char *data, qsizetype offset)
+{
+    return QVector3D(readLittleEndian<float>(data, offset), readLittleEndian<float>(data, offset + 4),
+                     readLittleEndian<float>(data, offset + 8));
+}
+
+static bool isFinite(const QVector3D &vector)
+{
+    return qIsFinite(vector.x()) && qIsFinite(vector.y()) && qIsFinite(vector.z());
+}
+
+template <typename T>
+static void appendLittleEndian(QByteArray &out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+static void appendVector(QByteArray &out, const QVector3D &vector)
+{
+    appendLittleEndian<float>(out, vector.x());
+    appendLittleEndian<float>(out, vector.y());
+    appendLittleEndian<float>(out, vector.z());
+}
+
+int SceneProtocol::recordSize(MessageType type)
+{
+    switch (type) {
+    case MessageType::CREATE:
+        return 16;
+    case MessageType::REMOVE:
+        return 4;
+    case MessageType::TRANSFORM:
+        return 32;
+    case MessageType::CAMERA:
+        return 28;
+    case MessageType::FENCE:
+        return 8;
+    }
+    return -1;
+}
+
+SceneProtocol::DecodeResult SceneProtocol::decode(const char *data, qsizetype size, quint32 client, std::vector<Command> &out,
+                                                  qsizetype &consumed)
+{
+    if (size < HeaderSize)
+        return DecodeResult::INCOMPLETE;
+
+    const MessageType type = MessageType(quint8(data[0]));
+    const quint32 count = readLittleEndian<quint32>(data, 4);
+    const int stride = recordSize(type);
+    if (stride < 0 || count > MaxRecords)
+        return DecodeResult::INVALID;
+    if ((type == MessageType::CAMERA || type == MessageType::FENCE) && count != 1)
+        return DecodeResult::INVALID;
+
+    const qsizetype length = HeaderSize + qsizetype(count) * stride;
+    if (size < length)
+        return DecodeResult::INCOMPLETE;
+
+    const size_t first = out.size();
+    out.reserve(out.size() + count);
+    for (quint32 i = 0; i < count; i++) {
+        const char *record = data + HeaderSize + qsizetype(i) * stride;
+        Command command = {};
+        command.Type = type;
+        command.Client = client;
+        switch (type) {
+        case MessageType::CREATE:
+            command.Id = readLittleEndian<quint32>(record, 0);
+            command.Position = readVector(record, 4);
+            break;
+        case MessageType::REMOVE:
+            command.Id = readLittleEndian<quint32>(record, 0);
+            break;
+        case MessageType::TRANSFORM:
+            command.Id = readLittleEndian<quint32>(record, 0);
+            command.Position = readVector(record, 4);
+            command.Rotation = QQuaternion(readLittleEndian<float>(record, 28), readVector(record, 16));
+            break;
+        case MessageType::CAMERA:
+            command.Position = readVector(record, 0);
+            command.LookAt = readVector(record, 12);
+            command.Fov = readLittleEndian<float>(record, 24);
+            break;
+        case MessageType::FENCE:
+            command.Token = readLittleEndian<quint64>(record, 0);
+            break;
+        }
+        // NaN or infinity would end up in shape transformations, the collision world and the camera
+        if (!isFinite(command.Position) || !isFinite(command.LookAt) || !isFinite(command.Rotation.vector()) ||
+            !qIsFinite(command.Rotation.scalar()) || !qIsFinite(command.Fov)) {
+            out.resize(first);
+            return DecodeResult::INVALID;
+        }
+        out.push_back(command);
+    }
+
+    consumed = length;
+    return DecodeResult::OK;
+}
+
+void SceneProtocol::appendHeader(QByteArray &out, MessageType type, quint32 count)
+{
+    const char header[4] = { char(type), 0, 0, 0 };
+    out.append(header, sizeof(header));
+    appendLittleEndian<quint32>(out, count);
+}
+
+void SceneProtocol::appendCreate(QByteArray &out, quint32 id, const QVector3D &position)
+{
+    appendLittleEndian<quint32>(out, id);
+    appendVector(out, position);
+}
+
+void SceneProtocol::appendRemove(QByteArray &out, quint32 id)
+{
+    appendLittleEndian<quint32>(out, id);
+}
+
+void SceneProtocol::appendTransform(QByteArray &out, quint32 id, const QVector3D &position, const QQuaternion &rotation)
+{
+    appendLittleEndian<quint32>(out, id);
+    appendVector(out, position);
+    appendLittleEndian<float>(out, rotation.x());
+    appendLittleEndian<float>(out, rotation.y());
+    appendLittleEndian<float>(out, rotation.z());
+    appendLittleEndian<float>(out, rotation.scalar());
+}
+
+void SceneProtocol::appendCameraMessage(QByteArray &out, const QVector3D &position, const QVector3D &lookAt, float fov)
+{
+    appendHeader(out, MessageType::CAMERA, 1);
+    appendVector(out, position);
+    appendVector(out, lookAt);
+    appendLittleEndian<float>(out, fov);
+}
+
+void SceneProtocol::appendFenceMessage(QByteArray &out, quint64 token)
+{
+    appendHeader(out, MessageType::FENCE, 1);
+    appendLittleEndian<quint64>(out, token);
+}
@@ -0,0 +1,298 @@
+#include "SceneRenderer.h"
+#include "SceneModel.h"
+#include "Frustum.h"
+#include "Shape.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#ifndef GL_PRIMITIVE_RESTART_FIXED_INDEX
+#define GL_PRIMITIVE_RESTART_FIXED_INDEX 0x8D69
+#endif
+
+SceneRenderer::SceneRenderer()
+{
+}
+
+bool SceneRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    m_glState.initialize(this);
+
+    m_resources = RenderResources::acquire(m_glState);
+    if (!m_resources)
+        return false;
+
+    // Enable depth buffer
+    m_glState.enable(GL_DEPTH_TEST);
+    // Enable back face culling
+    m_glState.enable(GL_CULL_FACE);
+    // Blending is only switched on for the transparent pass.
+    // Destination alpha stays at the cleared 1.0 so exported images come out opaque.
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE);
+
+    // Static chunks separate their strips with the largest index, mesh indices never get that far
+    if (m_resources->primitiveRestart()) {
+        m_glState.enable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    }
+
+    glClearColor(0.8f, 0.8f, 0.8f, 1.0f);
+    return true;
+}
+
+void SceneRenderer::release()
+{
+    m_scaledTarget.reset();
+    // The last view of a share group takes the shared GL objects with it
+    m_resources.reset();
+    m_glState.invalidate();
+}
+
+bool SceneRenderer::uploadPending()
+{
+    if (!m_resources)
+        return false;
+    return m_resources->textures().uploadPending(m_glState);
+}
+
+void SceneRenderer::render(const SceneModel &model, const QMatrix4x4 &projection, const QMatrix4x4 &view, float nearZ, float farZ)
+{
+    if (!m_resources)
+        return;
+
+    m_glState.beginFrame();
+    // Other views of the share group draw with the same program and buffers in between our frames
+    m_glState.invalidateShared();
+    m_resources->releaseUnusedBuffers();
+
+    // Clear color and depth buffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    QOpenGLShaderProgram &program = m_resources->program();
+    const ShaderLocations &locations = m_resources->locations();
+    TextureStreamer &textures = m_resources->textures();
+
+    // Queue the visible shapes and sort them by state and depth
+    const Frustum frustum(projection * view);
+    m_renderQueue.setDepthRange(nearZ, farZ);
+    m_renderQueue.clear();
+    const bool staticBatching = model.staticBatching();
+    for (const auto &shape : model.shapes()) {
+        Shape *cube = shape.second;
+        // Drawn as part of their chunk
+        if (staticBatching && StaticBatcher::accepts(cube)) {
+            continue;
+        }
+        const auto mesh = cube->getMesh();
+        const QVector3D center = cube->getTransformation().column(3).toVector3D();
+        if (!frustum.intersectsSphere(center, mesh->getBoundingRadius())) {
+            continue;
+        }
+        const auto material = cube->getMaterial();
+        const RenderPass pass = material->isTransparent() ? RenderPass::TRANSPARENT : RenderPass::OPAQUE;
+        const float viewDepth = -view.map(center).z();
+        m_renderQueue.push(pass, program.programId(), mesh->ID(), material->ID, viewDepth, cube);
+    }
+    m_renderQueue.sort();
+
+    // Static chunks are opaque, they go before the queued opaque draws
+    if (staticBatching) {
+        drawStaticChunks(model.staticBatches(), frustum, projection, view);
+    }
+
+    bool blending = false;
+    for (const auto &item : m_renderQueue.items()) {
+        Shape *cube = item.Item;
+        const auto material = cube->getMaterial();
+
+        if (!blending && RenderQueue::passOf(item.Key) == RenderPass::TRANSPARENT) {
+            // Transparent draws come last, blend them over the opaque ones without writing depth
+            m_glState.enable(GL_BLEND);
+            glDepthMask(GL_FALSE);
+            blending = true;
+        }
+
+        // Every draw states the full pipeline it needs, the cache drops whatever is already in place.
+        // Mesh data is uploaded once per share group, draws of the same mesh are adjacent after sorting.
+        const GpuMesh &mesh = m_resources->meshBuffers(cube->getMesh(), m_glState);
+        m_glState.useProgram(program.programId());
+        m_glState.bindBuffer(GL_ARRAY_BUFFER, mesh.VertexBuffer.bufferId());
+        m_glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.IndexBuffer.bufferId());
+
+        // Let GPU do the calculation of the final mvp
+        m_glState.setUniform(locations.Proj, projection);
+        m_glState.setUniform(locations.View, view);
+        m_glState.setUniform(locations.Trans, cube->getTransformation());
+
+        // Surface texture, untextured materials sample plain white
+        m_glState.activeTexture(GL_TEXTURE0);
+        m_glState.bindTexture(GL_TEXTURE_2D, textures.texture(material->Texture));
+        m_glState.setUniform(locations.Texture, 0);
+
+        // Vertex positions
+        m_glState.enableVertexAttribArray(locations.Position);
+        m_glState.vertexAttribPointer(locations.Position, 3, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, pos));
+
+        // Colors for the surfaces
+        m_glState.enableVertexAttribArray(locations.Color);
+        m_glState.vertexAttribPointer(locations.Color, 4, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, color));
+
+        // Texture coordinates
+        m_glState.enableVertexAttribArray(locations.Texcoord);
+        m_glState.vertexAttribPointer(locations.Texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, texcoord));
+
+        // Draw the shape
+        glDrawElements(GL_TRIANGLE_STRIP, mesh.IndexCount, GL_UNSIGNED_SHORT, nullptr);
+    }
+
+    if (blending) {
+        m_glState.disable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+    }
+
+    if (Shape *selected = model.selectedShape()) {
+        // Draw x-y-z axes of the selected shape from its center
+        m_glState.useProgram(program.programId());
+        m_glState.bindBuffer(GL_ARRAY_BUFFER, m_resources->axesBuffer().bufferId());
+        m_glState.setUniform(locations.Proj, projection);
+        m_glState.setUniform(locations.View, view);
+        m_glState.setUniform(locations.Trans, selected->getTransformation());
+        m_glState.activeTexture(GL_TEXTURE0);
+        m_glState.bindTexture(GL_TEXTURE_2D, textures.texture(QString()));
+        m_glState.setUniform(locations.Texture, 0);
+
+        m_glState.enableVertexAttribArray(locations.Position);
+        m_glState.vertexAttribPointer(locations.Position, 3, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, pos));
+        m_glState.enableVertexAttribArray(locations.Color);
+        m_glState.vertexAttribPointer(locations.Color, 4, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, color));
+        m_glState.enableVertexAttribArray(locations.Texcoord);
+        m_glState.vertexAttribPointer(locations.Texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, texcoord));
+
+        glDrawArrays(GL_LINES, 0, m_resources->axesVertexCount());
+    }
+
+    const GLStateStats &stats = m_glState.stats();
+    qCDebug(lcGLState) << "GL state calls issued:" << stats.Issued << "elided:" << stats.Elided;
+}
+
+void SceneRenderer::drawStaticChunks(const StaticBatcher &batches, const Frustum &frustum, const QMatrix4x4 &projection,
+                                     const QMatrix4x4 &view)
+{
+    m_visibleChunks.clear();
+    for (const auto &chunk : batches.chunks()) {
+        if (frustum.intersectsSphere(chunk->Center, chunk->Radius)) {
+            m_visibleChunks.push_back({ -view.map(chunk->Center).z(), &chunk });
+        }
+    }
+    // Front-to-back for early-Z, there are few enough chunks for a plain sort
+    std::sort(m_visibleChunks.begin(), m_visibleChunks.end(),
+              [](const VisibleChunk &a, const VisibleChunk &b) { return a.ViewDepth < b.ViewDepth; });
+
+    static const QMatrix4x4 identity;
+    QOpenGLShaderProgram &program = m_resources->program();
+    const ShaderLocations &locations = m_resources->locations();
+    TextureStreamer &textures = m_resources->textures();
+    for (const VisibleChunk &visible : m_visibleChunks) {
+        const std::shared_ptr<StaticChunk> &chunk = *visible.Chunk;
+        const GpuChunk &gpu = m_resources->chunkBuffers(chunk, m_glState);
+        m_glState.useProgram(program.programId());
+        m_glState.bindBuffer(GL_ARRAY_BUFFER, gpu.VertexBuffer.bufferId());
+        m_glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.IndexBuffer.bufferId());
+
+        // Vertices are already in world space
+        m_glState.setUniform(locations.Proj, projection);
+        m_glState.setUniform(locations.View, view);
+        m_glState.setUniform(locations.Trans, identity);
+
+        m_glState.activeTexture(GL_TEXTURE0);
+        m_glState.bindTexture(GL_TEXTURE_2D, textures.texture(chunk->Texture));
+        m_glState.setUniform(locations.Texture, 0);
+
+        m_glState.enableVertexAttribArray(locations.Position);
+        m_glState.vertexAttribPointer(locations.Position, 3, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, pos));
+        m_glState.enableVertexAttribArray(locations.Color);
+        m_glState.vertexAttribPointer(locations.Color, 4, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, color));
+        m_glState.enableVertexAttribArray(locations.Texcoord);
+        m_glState.vertexAttribPointer(locations.Texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(VerticeInfo), offsetof(VerticeInfo, texcoord));
+
+        glDrawElements(gpu.Mode, gpu.IndexCount, GL_UNSIGNED_INT, nullptr);
+    }
+}
+
+void SceneRenderer::renderScaled(const SceneModel &model, const QMatrix4x4 &projection, const QMatrix4x4 &view, float nearZ, float farZ,
+                                 const QSize &renderSize, const QSize &outputSize, GLuint outputFramebuffer)
+{
+    if (!m_resources)
+        return;
+
+    if (renderSize == outputSize) {
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        glViewport(0, 0, outputSize.width(), outputSize.height());
+        render(model, projection, view, nearZ, farZ);
+        return;
+    }
+
+    if (!m_scaledTarget || m_scaledTarget->size() != outputSize) {
+        m_scaledTarget.reset(new QOpenGLFramebufferObject(outputSize, QOpenGLFramebufferObject::CombinedDepthStencil));
+        // Qt binds the new texture and framebuffer behind the cache's back
+        m_glState.invalidate();
+        m_glState.activeTexture(GL_TEXTURE0);
+        m_glState.bindTexture(GL_TEXTURE_2D, m_scaledTarget->texture());
+        // The upscale filter relies on bilinear taps
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // Capabilities set once in initialize() were dropped with the rest of the cache
+        m_glState.enable(GL_DEPTH_TEST);
+        m_glState.enable(GL_CULL_FACE);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_scaledTarget->handle());
+    glViewport(0, 0, renderSize.width(), renderSize.height());
+    // Only the rendered corner is sampled, clearing the rest would be wasted bandwidth
+    m_glState.enable(GL_SCISSOR_TEST);
+    glScissor(0, 0, renderSize.width(), renderSize.height());
+    render(model, projection, view, nearZ, farZ);
+    m_glState.disable(GL_SCISSOR_TEST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+    glViewport(0, 0, outputSize.width(), outputSize.height());
+    upscale(renderSize, outputSize);
+}
+
+void SceneRenderer::upscale(const QSize &renderSize, const QSize &outputSize)
+{
+    QOpenGLShaderProgram &program = m_resources->upscaleProgram();
+    const UpscaleLocations &locations = m_resources->upscaleLocations();
+    const ShaderLocations &sceneLocations = m_resources->locations();
+
+    // Every output pixel is written once, depth and culling only get in the way
+    m_glState.disable(GL_DEPTH_TEST);
+    m_glState.disable(GL_CULL_FACE);
+    // The triangle is generated from gl_VertexID, leave no scene array enabled
+    m_glState.disableVertexAttribArray(sceneLocations.Position);
+    m_glState.disableVertexAttribArray(sceneLocations.Color);
+    m_glState.disableVertexAttribArray(sceneLocations.Texcoord);
+
+    m_glState.useProgram(program.programId());
+    m_glState.activeTexture(GL_TEXTURE0);
+    m_glState.bindTexture(GL_TEXTURE_2D, m_scaledTarget->texture());
+    m_glState.setUniform(locations.Texture, 0);
+    glUniform2f(locations.TextureSize, outputSize.width(), outputSize.height());
+    glUniform2f(locations.SourceScale, (float)renderSize.width() / outputSize.width(), (float)renderSize.height() / outputSize.height());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    m_glState.enable(GL_DEPTH_TEST);
+    m_glState.enable(GL_CULL_FACE);
+}
+
+const GLStateStats &SceneRenderer::stats() const
+{
+    return m_glState.stats();
+}
+
+TextureStreamer &SceneRenderer::textures()
+{
+    return m_resources->textures();
+}
@@ -0,0 +1,157 @@
+#include "StaticBatcher.h"
+#include "Shape.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+static std::atomic<quint32> s_nextChunkId { 1 };
+
+StaticBatcher::StaticBatcher(float cellSize) :
+    m_cellSize(cellSize),
+    m_enabled(false),
+    m_dirty(false)
+{
+}
+
+bool StaticBatcher::accepts(Shape *shape)
+{
+    return shape->isStatic() && !shape->getMaterial()->isTransparent();
+}
+
+void StaticBatcher::setEnabled(bool enabled)
+{
+    if (!enabled) {
+        clear();
+    }
+    m_enabled = enabled;
+}
+
+bool StaticBatcher::isEnabled() const
+{
+    return m_enabled;
+}
+
+void StaticBatcher::add(Shape *shape)
+{
+    if (!m_enabled || !accepts(shape) || m_shapeChunks.find(shape) != m_shapeChunks.end())
+        return;
+
+    const ChunkKey key = keyOf(shape);
+    ChunkState &state = m_chunks[key];
+    if (!state.Chunk) {
+        state.Chunk = std::make_shared<StaticChunk>();
+        state.Chunk->ID = s_nextChunkId++;
+        state.Chunk->Texture = std::get<3>(key);
+        state.Chunk->Radius = 0.0f;
+        state.Chunk->Generation = 0;
+        m_dirty = true;
+    }
+    state.Chunk->Shapes.push_back(shape);
+    m_shapeChunks.emplace(shape, key);
+}
+
+void StaticBatcher::remove(Shape *shape)
+{
+    auto it = m_shapeChunks.find(shape);
+    if (it == m_shapeChunks.end())
+        return;
+
+    auto chunk = m_chunks.find(it->second);
+    m_shapeChunks.erase(it);
+    if (chunk == m_chunks.end())
+        return;
+
+    ChunkState &state = chunk->second;
+    std::vector<Shape *> &shapes = state.Chunk->Shapes;
+    shapes.erase(std::find(shapes.begin(), shapes.end(), shape));
+    if (shapes.empty()) {
+        m_chunks.erase(chunk);
+        m_dirty = true;
+    } else {
+        state.NeedsRebuild = true;
+    }
+}
+
+void StaticBatcher::clear()
+{
+    m_chunks.clear();
+    m_shapeChunks.clear();
+    m_chunkList.clear();
+    m_dirty = false;
+}
+
+const std::vector<std::shared_ptr<StaticChunk>> &StaticBatcher::chunks() const
+{
+    for (auto &chunk : m_chunks) {
+        ChunkState &state = chunk.second;
+        if (state.NeedsRebuild || state.BuiltShapes < state.Chunk->Shapes.size()) {
+            build(state);
+        }
+    }
+
+    if (m_dirty) {
+        m_chunkList.clear();
+        m_chunkList.reserve(m_chunks.size());
+        for (const auto &chunk : m_chunks) {
+            m_chunkList.push_back(chunk.second.Chunk);
+        }
+        m_dirty = false;
+    }
+    return m_chunkList;
+}
+
+StaticBatcher::ChunkKey StaticBatcher::keyOf(Shape *shape) const
+{
+    // Shapes go to the cell holding their origin, chunk bounds grow to whatever the meshes cover
+    const QVector3D position = shape->getTransformation().column(3).toVector3D() / m_cellSize;
+    return ChunkKey(int(std::floor(position.x())), int(std::floor(position.y())), int(std::floor(position.z())),
+                    shape->getMaterial()->Texture);
+}
+
+void StaticBatcher::build(ChunkState &state)
+{
+    StaticChunk &chunk = *state.Chunk;
+    if (state.NeedsRebuild) {
+        // Removals leave holes, start over so the buffers stay compact
+        chunk.Vertices.clear();
+        chunk.Indices.clear();
+        chunk.Generation++;
+        state.BuiltShapes = 0;
+        state.NeedsRebuild = false;
+    }
+
+    for (size_t i = state.BuiltShapes; i < chunk.Shapes.size(); i++) {
+        Shape *shape = chunk.Shapes[i];
+        const auto mesh = shape->getMesh();
+        const QMatrix4x4 &transformation = shape->getTransformation();
+        const GLuint baseVertex = chunk.Vertices.size();
+
+        for (const auto &vertex : mesh->getVertices()) {
+            VerticeInfo merged = vertex;
+            merged.pos = transformation.map(vertex.pos);
+            if (chunk.Vertices.empty()) {
+                state.Min = merged.pos;
+                state.Max = merged.pos;
+            } else {
+                state.Min = QVector3D(qMin(state.Min.x(), merged.pos.x()), qMin(state.Min.y(), merged.pos.y()),
+                                      qMin(state.Min.z(), merged.pos.z()));
+                state.Max = QVector3D(qMax(state.Max.x(), merged.pos.x()), qMax(state.Max.y(), merged.pos.y()),
+                                      qMax(state.Max.z(), merged.pos.z()));
+            }
+            chunk.Vertices.push_back(merged);
+        }
+
+        // Restarting keeps every shape's strip, degenerate joins included, exactly as its own draw would see it
+        if (!chunk.Indices.empty()) {
+            chunk.Indices.push_back(STATIC_BATCH_RESTART_INDEX);
+        }
+        for (GLushort index : mesh->getIndices()) {
+            chunk.Indices.push_back(baseVertex + index);
+        }
+    }
+    state.BuiltShapes = chunk.Shapes.size();
+
+    chunk.Center = (state.Min + state.Max) * 0.5f;
+    chunk.Radius = (state.Max - state.Min).length() * 0.5f;
+}
@@ -0,0 +1,292 @@
+#include "TextureDecoder.h"
+
+// clang-format off
+static const int s_etcModifiers[8][2] = {
+    {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+    { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int s_etcDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int s_eacModifiers[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 }, { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 }, { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 }, { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 }, { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 }, { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 }, { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 }, { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+};
+// clang-format on
+
+static inline uchar clamp255(int value)
+{
+    return uchar(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline int extend4(int v)
+{
+    return (v << 4) | v;
+}
+
+static inline int extend5(int v)
+{
+    return (v << 3) | (v >> 2);
+}
+
+static inline int extend6(int v)
+{
+    return (v << 2) | (v >> 4);
+}
+
+static inline int extend7(int v)
+{
+    return (v << 1) | (v >> 6);
+}
+
+static inline quint64 readBigEndian64(const uchar *data)
+{
+    quint64 value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+static inline void writeTexel(uchar *rgba, int x, int y, int r, int g, int b)
+{
+    uchar *texel = rgba + (y * 4 + x) * 4;
+    texel[0] = clamp255(r);
+    texel[1] = clamp255(g);
+    texel[2] = clamp255(b);
+    texel[3] = 255;
+}
+
+// Shared by BC1, BC2 and BC3, the latter two never use the three color mode
+static void decodeColorBlock(const uchar *block, uchar *rgba, bool threeColorMode, bool punchThroughAlpha)
+{
+    const int c0 = block[0] | (block[1] << 8);
+    const int c1 = block[2] | (block[3] << 8);
+
+    int palette[4][4];
+    palette[0][0] = extend5((c0 >> 11) & 31);
+    palette[0][1] = extend6((c0 >> 5) & 63);
+    palette[0][2] = extend5(c0 & 31);
+    palette[1][0] = extend5((c1 >> 11) & 31);
+    palette[1][1] = extend6((c1 >> 5) & 63);
+    palette[1][2] = extend5(c1 & 31);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    if (c0 > c1 || !threeColorMode) {
+        for (int i = 0; i < 3; i++) {
+            palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+        }
+    } else {
+        for (int i = 0; i < 3; i++) {
+            palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+            palette[3][i] = 0;
+        }
+        palette[3][3] = punchThroughAlpha ? 0 : 255;
+    }
+
+    const quint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (quint32(block[7]) << 24);
+    for (int i = 0; i < 16; i++) {
+        const int *color = palette[(indices >> (2 * i)) & 3];
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = uchar(color[c]);
+        }
+    }
+}
+
+void TextureDecoder::decodeBC1(const uchar *block, uchar *rgba, bool punchThroughAlpha)
+{
+    decodeColorBlock(block, rgba, true, punchThroughAlpha);
+}
+
+void TextureDecoder::decodeBC2(const uchar *block, uchar *rgba)
+{
+    decodeColorBlock(block + 8, rgba, false, false);
+    for (int i = 0; i < 16; i++) {
+        const int alpha = (block[i / 2] >> ((i & 1) * 4)) & 15;
+        rgba[i * 4 + 3] = uchar(alpha * 17);
+    }
+}
+
+void TextureDecoder::decodeBC3(const uchar *block, uchar *rgba)
+{
+    decodeColorBlock(block + 8, rgba, false, false);
+
+    int palette[8];
+    palette[0] = block[0];
+    palette[1] = block[1];
+    if (palette[0] > palette[1]) {
+        for (int k = 2; k < 8; k++) {
+            palette[k] = ((8 - k) * palette[0] + (k - 1) * palette[1]) / 7;
+        }
+    } else {
+        for (int k = 2; k < 6; k++) {
+            palette[k] = ((6 - k) * palette[0] + (k - 1) * palette[1]) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    quint64 indices = 0;
+    for (int i = 7; i >= 2; i--) {
+        indices = (indices << 8) | block[i];
+    }
+    for (int i = 0; i < 16; i++) {
+        rgba[i * 4 + 3] = uchar(palette[(indices >> (3 * i)) & 7]);
+    }
+}
+
+// Pixel indices are stored column by column, the MSB plane in the upper 16 bits
+static inline int etcPixelIndex(quint64 bits, int x, int y)
+{
+    const int k = x * 4 + y;
+    return int(((bits >> (k + 16)) & 1) << 1 | ((bits >> k) & 1));
+}
+
+static void decodeETCPaintColors(quint64 bits, uchar *rgba, const int paint[4][3])
+{
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const int *color = paint[etcPixelIndex(bits, x, y)];
+            writeTexel(rgba, x, y, color[0], color[1], color[2]);
+        }
+    }
+}
+
+static void decodeETCModeT(quint64 bits, uchar *rgba)
+{
+    const int c1[3] = { extend4(int(((bits >> 59) & 3) << 2 | ((bits >> 56) & 3))), extend4(int((bits >> 52) & 15)),
+                        extend4(int((bits >> 48) & 15)) };
+    const int c2[3] = { extend4(int((bits >> 44) & 15)), extend4(int((bits >> 40) & 15)), extend4(int((bits >> 36) & 15)) };
+    const int d = s_etcDistances[((bits >> 34) & 3) << 1 | ((bits >> 32) & 1)];
+
+    int paint[4][3];
+    for (int i = 0; i < 3; i++) {
+        paint[0][i] = c1[i];
+        paint[1][i] = c2[i] + d;
+        paint[2][i] = c2[i];
+        paint[3][i] = c2[i] - d;
+    }
+    decodeETCPaintColors(bits, rgba, paint);
+}
+
+static void decodeETCModeH(quint64 bits, uchar *rgba)
+{
+    const int r1 = int((bits >> 59) & 15);
+    const int g1 = int(((bits >> 56) & 7) << 1 | ((bits >> 52) & 1));
+    const int b1 = int(((bits >> 51) & 1) << 3 | ((bits >> 48) & 3) << 1 | ((bits >> 47) & 1));
+    const int r2 = int((bits >> 43) & 15);
+    const int g2 = int((bits >> 39) & 15);
+    const int b2 = int((bits >> 35) & 15);
+    // The lowest distance bit is implied by the order of the two base colors
+    const int ordering = ((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2) ? 1 : 0;
+    const int d = s_etcDistances[((bits >> 34) & 1) << 2 | ((bits >> 32) & 1) << 1 | ordering];
+
+    const int c1[3] = { extend4(r1), extend4(g1), extend4(b1) };
+    const int c2[3] = { extend4(r2), extend4(g2), extend4(b2) };
+    int paint[4][3];
+    for (int i = 0; i < 3; i++) {
+        paint[0][i] = c1[i] + d;
+        paint[1][i] = c1[i] - d;
+        paint[2][i] = c2[i] + d;
+        paint[3][i] = c2[i] - d;
+    }
+    decodeETCPaintColors(bits, rgba, paint);
+}
+
+static void decodeETCModePlanar(quint64 bits, uchar *rgba)
+{
+    const int ro = extend6(int((bits >> 57) & 63));
+    const int go = extend7(int(((bits >> 56) & 1) << 6 | ((bits >> 49) & 63)));
+    const int bo = extend6(int(((bits >> 48) & 1) << 5 | ((bits >> 43) & 3) << 3 | ((bits >> 39) & 7)));
+    const int rh = extend6(int(((bits >> 34) & 31) << 1 | ((bits >> 32) & 1)));
+    const int gh = extend7(int((bits >> 25) & 127));
+    const int bh = extend6(int((bits >> 19) & 63));
+    const int rv = extend6(int((bits >> 13) & 63));
+    const int gv = extend7(int((bits >> 6) & 127));
+    const int bv = extend6(int(bits & 63));
+
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            writeTexel(rgba, x, y, (x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2, (x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2,
+                       (x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2);
+        }
+    }
+}
+
+void TextureDecoder::decodeETC2RGB(const uchar *block, uchar *rgba)
+{
+    const quint64 bits = readBigEndian64(block);
+    const bool differential = (bits >> 33) & 1;
+    const bool flip = (bits >> 32) & 1;
+
+    int base[2][3];
+    if (!differential) {
+        for (int i = 0; i < 3; i++) {
+            base[0][i] = extend4(block[i] >> 4);
+            base[1][i] = extend4(block[i] & 15);
+        }
+    } else {
+        int second[3];
+        for (int i = 0; i < 3; i++) {
+            const int delta = block[i] & 7;
+            base[0][i] = block[i] >> 3;
+            second[i] = base[0][i] + (delta >= 4 ? delta - 8 : delta);
+        }
+        // ETC2 reuses the invalid ETC1 overflow cases to signal its extra modes
+        if (second[0] < 0 || second[0] > 31) {
+            decodeETCModeT(bits, rgba);
+            return;
+        }
+        if (second[1] < 0 || second[1] > 31) {
+            decodeETCModeH(bits, rgba);
+            return;
+        }
+        if (second[2] < 0 || second[2] > 31) {
+            decodeETCModePlanar(bits, rgba);
+            return;
+        }
+        for (int i = 0; i < 3; i++) {
+            base[0][i] = extend5(base[0][i]);
+            base[1][i] = extend5(second[i]);
+        }
+    }
+
+    const int codewords[2] = { block[3] >> 5, (block[3] >> 2) & 7 };
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const int subBlock = flip ? (y >= 2) : (x >= 2);
+            const int index = etcPixelIndex(bits, x, y);
+            int modifier = s_etcModifiers[codewords[subBlock]][index & 1];
+            if (index & 2) {
+                modifier = -modifier;
+            }
+            writeTexel(rgba, x, y, base[subBlock][0] + modifier, base[subBlock][1] + modifier, base[subBlock][2] + modifier);
+        }
+    }
+}
+
+void TextureDecoder::decodeETC2RGBA(const uchar *block, uchar *rgba)
+{
+    decodeETC2RGB(block + 8, rgba);
+
+    const int base = block[0];
+    const int multiplier = block[1] >> 4;
+    const int *modifiers = s_eacModifiers[block[1] & 15];
+    quint64 indices = 0;
+    for (int i = 2; i < 8; i++) {
+        indices = (indices << 8) | block[i];
+    }
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const int k = x * 4 + y;
+            rgba[(y * 4 + x) * 4 + 3] = clamp255(base + modifiers[(indices >> (45 - 3 * k)) & 7] * multiplier);
+        }
+    }
+}
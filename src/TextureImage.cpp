@@ -0,0 +1,350 @@
+#include "TextureImage.h"
+#include "TextureDecoder.h"
+
+#include <QFile>
+#include <QImage>
+#include <QtEndian>
+#include <QDebug>
+
+#include <cstring>
+
+static const uchar s_ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+template<typename T>
+static T readLittleEndian(const QByteArray &data, qint64 offset)
+{
+    return qFromLittleEndian<T>(data.constData() + offset);
+}
+
+static constexpr quint32 fourCC(char a, char b, char c, char d)
+{
+    return quint32(uchar(a)) | (quint32(uchar(b)) << 8) | (quint32(uchar(c)) << 16) | (quint32(uchar(d)) << 24);
+}
+
+// Levels from width x height down to 1x1, more than that can only come from a corrupt header
+static quint32 mipChainLength(quint32 width, quint32 height)
+{
+    quint32 length = 1;
+    while (length < 32 && (qMax(width, height) >> length) > 0) {
+        length++;
+    }
+    return length;
+}
+
+bool TextureImage::load(const QString &path)
+{
+    Levels.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "TextureImage::load: Failed to open" << path;
+        return false;
+    }
+    const QByteArray data = file.readAll();
+
+    bool loaded = false;
+    if (data.size() >= 12 && std::memcmp(data.constData(), s_ktx2Identifier, sizeof(s_ktx2Identifier)) == 0) {
+        loaded = loadKTX2(data);
+    } else if (data.size() >= 4 && readLittleEndian<quint32>(data, 0) == fourCC('D', 'D', 'S', ' ')) {
+        loaded = loadDDS(data);
+    } else {
+        loaded = loadImage(path);
+    }
+
+    if (!loaded) {
+        qDebug() << "TextureImage::load: Unsupported or corrupt texture" << path;
+        Levels.clear();
+    }
+    return loaded;
+}
+
+TextureImage TextureImage::decompressed() const
+{
+    if (!isCompressed()) {
+        return *this;
+    }
+
+    TextureImage image;
+    image.Format = TextureFormat::RGBA8;
+    const int stride = blockBytes(Format);
+    uchar texels[16 * 4];
+    for (const auto &level : Levels) {
+        TextureLevel decoded { level.Width, level.Height, QByteArray(level.Width * level.Height * 4, Qt::Uninitialized) };
+        const uchar *block = reinterpret_cast<const uchar *>(level.Data.constData());
+        uchar *pixels = reinterpret_cast<uchar *>(decoded.Data.data());
+
+        for (int by = 0; by < level.Height; by += 4) {
+            for (int bx = 0; bx < level.Width; bx += 4, block += stride) {
+                switch (Format) {
+                case TextureFormat::BC1_RGB:
+                    TextureDecoder::decodeBC1(block, texels, false);
+                    break;
+                case TextureFormat::BC1_RGBA:
+                    TextureDecoder::decodeBC1(block, texels, true);
+                    break;
+                case TextureFormat::BC2:
+                    TextureDecoder::decodeBC2(block, texels);
+                    break;
+                case TextureFormat::BC3:
+                    TextureDecoder::decodeBC3(block, texels);
+                    break;
+                case TextureFormat::ETC2_RGB8:
+                    TextureDecoder::decodeETC2RGB(block, texels);
+                    break;
+                case TextureFormat::ETC2_RGBA8:
+                    TextureDecoder::decodeETC2RGBA(block, texels);
+                    break;
+                default:
+                    break;
+                }
+
+                // Blocks on the right and bottom edge may hang over the level
+                const int columns = qMin(4, level.Width - bx);
+                const int rows = qMin(4, level.Height - by);
+                for (int y = 0; y < rows; y++) {
+                    std::memcpy(pixels + ((by + y) * level.Width + bx) * 4, texels + y * 16, columns * 4);
+                }
+            }
+        }
+        image.Levels.append(decoded);
+    }
+    return image;
+}
+
+bool TextureImage::isNull() const
+{
+    return Levels.isEmpty();
+}
+
+bool TextureImage::isCompressed() const
+{
+    return Format != TextureFormat::RGBA8;
+}
+
+qint64 TextureImage::byteSize() const
+{
+    qint64 size = 0;
+    for (const auto &level : Levels) {
+        size += level.Data.size();
+    }
+    return size;
+}
+
+int TextureImage::blockBytes(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::BC1_RGB:
+    case TextureFormat::BC1_RGBA:
+    case TextureFormat::ETC2_RGB8:
+        return 8;
+    case TextureFormat::BC2:
+    case TextureFormat::BC3:
+    case TextureFormat::ETC2_RGBA8:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+qint64 TextureImage::levelBytes(TextureFormat format, int width, int height)
+{
+    if (format == TextureFormat::RGBA8) {
+        return qint64(width) * height * 4;
+    }
+    return qint64((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+bool TextureImage::loadKTX2(const QByteArray &file)
+{
+    // 12 byte identifier, 9 header words, then the dfd/kvd/sgd index and the level index
+    static const qint64 levelIndexOffset = 80;
+    if (file.size() < levelIndexOffset)
+        return false;
+
+    const quint32 vkFormat = readLittleEndian<quint32>(file, 12);
+    const quint32 width = readLittleEndian<quint32>(file, 20);
+    const quint32 height = readLittleEndian<quint32>(file, 24);
+    const quint32 depth = readLittleEndian<quint32>(file, 28);
+    const quint32 layerCount = readLittleEndian<quint32>(file, 32);
+    const quint32 faceCount = readLittleEndian<quint32>(file, 36);
+    const quint32 levelCount = qMax<quint32>(readLittleEndian<quint32>(file, 40), 1);
+    const quint32 supercompression = readLittleEndian<quint32>(file, 44);
+
+    if (depth > 1 || layerCount > 1 || faceCount != 1 || supercompression != 0 || width == 0 || height == 0)
+        return false;
+
+    switch (vkFormat) {
+    case 37:    // VK_FORMAT_R8G8B8A8_UNORM
+    case 43:    // VK_FORMAT_R8G8B8A8_SRGB
+        Format = TextureFormat::RGBA8;
+        break;
+    case 131:    // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case 132:    // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        Format = TextureFormat::BC1_RGB;
+        break;
+    case 133:    // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    case 134:    // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+        Format = TextureFormat::BC1_RGBA;
+        break;
+    case 135:    // VK_FORMAT_BC2_UNORM_BLOCK
+    case 136:    // VK_FORMAT_BC2_SRGB_BLOCK
+        Format = TextureFormat::BC2;
+        break;
+    case 137:    // VK_FORMAT_BC3_UNORM_BLOCK
+    case 138:    // VK_FORMAT_BC3_SRGB_BLOCK
+        Format = TextureFormat::BC3;
+        break;
+    case 147:    // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+    case 148:    // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+        Format = TextureFormat::ETC2_RGB8;
+        break;
+    case 151:    // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+    case 152:    // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+        Format = TextureFormat::ETC2_RGBA8;
+        break;
+    default:
+        return false;
+    }
+
+    if (file.size() < levelIndexOffset + qint64(levelCount) * 24)
+        return false;
+
+    // Anything in the level index past the 1x1 mip is ignored
+    const quint32 usedLevelCount = qMin(levelCount, mipChainLength(width, height));
+    for (quint32 i = 0; i < usedLevelCount; i++) {
+        const int levelWidth = qMax<int>(int(width >> i), 1);
+        const int levelHeight = qMax<int>(int(height >> i), 1);
+        const quint64 offset = readLittleEndian<quint64>(file, levelIndexOffset + i * 24);
+        const quint64 length = readLittleEndian<quint64>(file, levelIndexOffset + i * 24 + 8);
+        const qint64 expected = levelBytes(Format, levelWidth, levelHeight);
+        if (length < quint64(expected) || offset + quint64(expected) > quint64(file.size()))
+            return false;
+        Levels.append({ levelWidth, levelHeight, file.mid(qint64(offset), expected) });
+    }
+    return true;
+}
+
+bool TextureImage::loadDDS(const QByteArray &file)
+{
+    // "DDS " magic, 124 byte DDS_HEADER, optional 20 byte DDS_HEADER_DXT10
+    static const qint64 headerSize = 128;
+    static const quint32 DDPF_FOURCC = 0x4;
+    static const quint32 DDPF_RGB = 0x40;
+    static const quint32 DDSD_MIPMAPCOUNT = 0x20000;
+    if (file.size() < headerSize || readLittleEndian<quint32>(file, 4) != 124)
+        return false;
+
+    const quint32 flags = readLittleEndian<quint32>(file, 8);
+    const int height = int(readLittleEndian<quint32>(file, 12));
+    const int width = int(readLittleEndian<quint32>(file, 16));
+    const quint32 mipMapCount = readLittleEndian<quint32>(file, 28);
+    const quint32 pixelFlags = readLittleEndian<quint32>(file, 80);
+    const quint32 pixelFourCC = readLittleEndian<quint32>(file, 84);
+    const quint32 bitCount = readLittleEndian<quint32>(file, 88);
+    const quint32 redMask = readLittleEndian<quint32>(file, 92);
+    const quint32 caps2 = readLittleEndian<quint32>(file, 112);
+
+    // Cube maps and volumes are not used by the scene
+    if (width <= 0 || height <= 0 || caps2 != 0)
+        return false;
+
+    // Some writers leave dwMipMapCount uninitialized when the flag is clear, and no chain goes past 1x1
+    const int levelCount = (flags & DDSD_MIPMAPCOUNT) ? int(qBound<quint32>(1, mipMapCount, mipChainLength(width, height))) : 1;
+
+    qint64 dataOffset = headerSize;
+    bool swapRedBlue = false;
+    if (pixelFlags & DDPF_FOURCC) {
+        switch (pixelFourCC) {
+        case fourCC('D', 'X', 'T', '1'):
+            Format = TextureFormat::BC1_RGBA;
+            break;
+        case fourCC('D', 'X', 'T', '3'):
+            Format = TextureFormat::BC2;
+            break;
+        case fourCC('D', 'X', 'T', '5'):
+            Format = TextureFormat::BC3;
+            break;
+        case fourCC('D', 'X', '1', '0'): {
+            if (file.size() < headerSize + 20 || readLittleEndian<quint32>(file, headerSize + 12) > 1)
+                return false;
+            dataOffset += 20;
+            switch (readLittleEndian<quint32>(file, headerSize)) {
+            case 28:    // DXGI_FORMAT_R8G8B8A8_UNORM
+            case 29:    // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+                Format = TextureFormat::RGBA8;
+                break;
+            case 71:    // DXGI_FORMAT_BC1_UNORM
+            case 72:    // DXGI_FORMAT_BC1_UNORM_SRGB
+                Format = TextureFormat::BC1_RGBA;
+                break;
+            case 74:    // DXGI_FORMAT_BC2_UNORM
+            case 75:    // DXGI_FORMAT_BC2_UNORM_SRGB
+                Format = TextureFormat::BC2;
+                break;
+            case 77:    // DXGI_FORMAT_BC3_UNORM
+            case 78:    // DXGI_FORMAT_BC3_UNORM_SRGB
+                Format = TextureFormat::BC3;
+                break;
+            default:
+                return false;
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    } else if ((pixelFlags & DDPF_RGB) && bitCount == 32 && (redMask == 0x000000FF || redMask == 0x00FF0000)) {
+        Format = TextureFormat::RGBA8;
+        swapRedBlue = redMask == 0x00FF0000;
+    } else {
+        return false;
+    }
+
+    if (!readLevels(file, dataOffset, width, height, levelCount))
+        return false;
+
+    if (swapRedBlue) {
+        for (auto &level : Levels) {
+            uchar *pixels = reinterpret_cast<uchar *>(level.Data.data());
+            for (qint64 i = 0; i < level.Data.size(); i += 4) {
+                std::swap(pixels[i], pixels[i + 2]);
+            }
+        }
+    }
+    return true;
+}
+
+bool TextureImage::loadImage(const QString &path)
+{
+    QImage image(path);
+    if (image.isNull())
+        return false;
+
+    Format = TextureFormat::RGBA8;
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+    while (true) {
+        TextureLevel level { image.width(), image.height(), QByteArray(image.width() * image.height() * 4, Qt::Uninitialized) };
+        for (int y = 0; y < image.height(); y++) {
+            std::memcpy(level.Data.data() + y * image.width() * 4, image.constScanLine(y), image.width() * 4);
+        }
+        Levels.append(level);
+        if (image.width() == 1 && image.height() == 1)
+            break;
+        image = image.scaled(qMax(image.width() / 2, 1), qMax(image.height() / 2, 1), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return true;
+}
+
+bool TextureImage::readLevels(const QByteArray &file, qint64 offset, int width, int height, int levelCount)
+{
+    for (int i = 0; i < levelCount; i++) {
+        const int levelWidth = qMax(width >> i, 1);
+        const int levelHeight = qMax(height >> i, 1);
+        const qint64 size = levelBytes(Format, levelWidth, levelHeight);
+        if (offset + size > file.size())
+            return false;
+        Levels.append({ levelWidth, levelHeight, file.mid(offset, size) });
+        offset += size;
+    }
+    return true;
+}
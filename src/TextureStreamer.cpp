@@ -0,0 +1,295 @@
+#include "TextureStreamer.h"
+#include "GLStateCache.h"
+
+#include <QOpenGLContext>
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <cstring>
+
+#ifndef GL_TEXTURE_BASE_LEVEL
+#define GL_TEXTURE_BASE_LEVEL 0x813C
+#endif
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+static GLenum compressedInternalFormat(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::BC1_RGB:
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TextureFormat::BC1_RGBA:
+        return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case TextureFormat::BC2:
+        return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    case TextureFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case TextureFormat::ETC2_RGB8:
+        return GL_COMPRESSED_RGB8_ETC2;
+    case TextureFormat::ETC2_RGBA8:
+        return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    default:
+        return 0;
+    }
+}
+
+static bool isBC(TextureFormat format)
+{
+    return format == TextureFormat::BC1_RGB || format == TextureFormat::BC1_RGBA || format == TextureFormat::BC2 ||
+           format == TextureFormat::BC3;
+}
+
+static bool isETC2(TextureFormat format)
+{
+    return format == TextureFormat::ETC2_RGB8 || format == TextureFormat::ETC2_RGBA8;
+}
+
+TextureStreamer::TextureStreamer(QObject *parent) :
+    QObject(parent),
+    m_pbo(QOpenGLBuffer::PixelUnpackBuffer),
+    m_white(0),
+    m_placeholder(0),
+    m_uploadBudget(4 * 1024 * 1024),
+    m_supportsBC(false),
+    m_supportsETC2(false),
+    m_supportsPBO(false)
+{
+    // Decoding is CPU heavy, leave the remaining cores to the GUI and the GL driver
+    m_pool.setMaxThreadCount(2);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // Workers write into this object, let the running ones finish before it goes away
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void TextureStreamer::initialize(GLStateCache &state)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    const QSurfaceFormat format = context->format();
+    const bool gl43 = format.majorVersion() > 4 || (format.majorVersion() == 4 && format.minorVersion() >= 3);
+    m_supportsBC = context->hasExtension("GL_EXT_texture_compression_s3tc");
+    m_supportsETC2 = context->isOpenGLES() ? format.majorVersion() >= 3 : (gl43 || context->hasExtension("GL_ARB_ES3_compatibility"));
+    m_supportsPBO = (!context->isOpenGLES() || format.majorVersion() >= 3) && m_pbo.create();
+    m_pbo.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    qDebug() << "TextureStreamer: BC" << m_supportsBC << "ETC2" << m_supportsETC2 << "PBO" << m_supportsPBO;
+
+    // clang-format off
+    static const uchar white[4] = { 255, 255, 255, 255 };
+    static const uchar checker[16] = {
+        200, 200, 200, 255,   120, 120, 120, 255,
+        120, 120, 120, 255,   200, 200, 200, 255
+    };
+    // clang-format on
+    m_white = createPlaceholder(white, 1, state);
+    m_placeholder = createPlaceholder(checker, 2, state);
+}
+
+void TextureStreamer::destroy()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+    {
+        QMutexLocker locker(&m_loadedMutex);
+        m_loaded.clear();
+    }
+
+    for (auto &texture : m_textures) {
+        deleteTexture(texture.second.Texture);
+    }
+    m_textures.clear();
+    m_streaming.clear();
+    deleteTexture(m_white);
+    deleteTexture(m_placeholder);
+    m_white = 0;
+    m_placeholder = 0;
+    m_pbo.destroy();
+}
+
+GLuint TextureStreamer::texture(const QString &path)
+{
+    if (path.isEmpty())
+        return m_white;
+
+    auto it = m_textures.find(path);
+    if (it == m_textures.end()) {
+        m_textures.emplace(path, Entry());
+        const bool decodeBC = !m_supportsBC;
+        const bool decodeETC2 = !m_supportsETC2;
+        m_pool.start([this, path, decodeBC, decodeETC2]() {
+            TextureImage image;
+            if (image.load(path) && ((decodeBC && isBC(image.Format)) || (decodeETC2 && isETC2(image.Format)))) {
+                image = image.decompressed();
+            }
+            {
+                QMutexLocker locker(&m_loadedMutex);
+                m_loaded.push_back({ path, std::move(image) });
+            }
+            emit textureLoaded();
+        });
+        return m_placeholder;
+    }
+
+    const Entry &entry = it->second;
+    if (entry.State == Residency::FAILED)
+        return m_white;
+    return entry.Sampleable ? entry.Texture : m_placeholder;
+}
+
+bool TextureStreamer::uploadPending(GLStateCache &state)
+{
+    adoptLoaded(state);
+
+    qint64 spent = 0;
+    bool budgetSpent = false;
+    while (!m_streaming.empty() && !budgetSpent) {
+        Entry &entry = m_textures[m_streaming.front()];
+        while (entry.NextLevel >= 0) {
+            const qint64 size = entry.Image.Levels[entry.NextLevel].Data.size();
+            // At least one mip goes up per frame, otherwise a level larger than the budget would never land
+            if (spent > 0 && spent + size > m_uploadBudget) {
+                budgetSpent = true;
+                break;
+            }
+            uploadLevel(entry, entry.NextLevel, state);
+            spent += size;
+            entry.NextLevel--;
+        }
+        if (entry.NextLevel < 0) {
+            entry.State = Residency::RESIDENT;
+            entry.Image = TextureImage();
+            m_streaming.pop_front();
+        }
+    }
+
+    if (spent > 0) {
+        emit texturesUploaded();
+    }
+    return !m_streaming.empty();
+}
+
+void TextureStreamer::setUploadBudget(qint64 bytesPerFrame)
+{
+    m_uploadBudget = bytesPerFrame;
+}
+
+void TextureStreamer::adoptLoaded(GLStateCache &state)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+    std::vector<LoadResult> loaded;
+    {
+        QMutexLocker locker(&m_loadedMutex);
+        loaded.swap(m_loaded);
+    }
+
+    for (auto &result : loaded) {
+        auto it = m_textures.find(result.Path);
+        if (it == m_textures.end())
+            continue;
+        Entry &entry = it->second;
+        if (result.Image.isNull()) {
+            entry.State = Residency::FAILED;
+            continue;
+        }
+
+        entry.Image = std::move(result.Image);
+        entry.NextLevel = entry.Image.Levels.size() - 1;
+        entry.State = Residency::STREAMING;
+
+        gl->glGenTextures(1, &entry.Texture);
+        state.activeTexture(GL_TEXTURE0);
+        state.bindTexture(GL_TEXTURE_2D, entry.Texture);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.NextLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.NextLevel);
+        m_streaming.push_back(result.Path);
+    }
+}
+
+void TextureStreamer::uploadLevel(Entry &entry, int index, GLStateCache &state)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+    const TextureLevel &level = entry.Image.Levels[index];
+    state.activeTexture(GL_TEXTURE0);
+    state.bindTexture(GL_TEXTURE_2D, entry.Texture);
+
+    // Stage through the pixel unpack buffer so the driver can copy asynchronously,
+    // fall back to client memory if it cannot be mapped
+    const void *pixels = level.Data.constData();
+    bool staged = false;
+    if (m_supportsPBO) {
+        m_pbo.bind();
+        // Re-allocating orphans the storage of the previous upload instead of waiting for it
+        m_pbo.allocate(level.Data.size());
+        void *staging = m_pbo.map(QOpenGLBuffer::WriteOnly);
+        if (staging) {
+            std::memcpy(staging, level.Data.constData(), level.Data.size());
+            staged = m_pbo.unmap();
+        }
+        if (staged) {
+            pixels = nullptr;
+        } else {
+            m_pbo.release();
+        }
+    }
+
+    if (entry.Image.isCompressed()) {
+        gl->glCompressedTexImage2D(GL_TEXTURE_2D, index, compressedInternalFormat(entry.Image.Format), level.Width, level.Height, 0,
+                                     level.Data.size(), pixels);
+    } else {
+        gl->glTexImage2D(GL_TEXTURE_2D, index, GL_RGBA, level.Width, level.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    if (staged) {
+        m_pbo.release();
+    }
+
+    // Mips go up smallest first, moving the base level down keeps the texture complete after every upload
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, index);
+    entry.Sampleable = true;
+}
+
+GLuint TextureStreamer::createPlaceholder(const uchar *rgba, int size, GLStateCache &state)
+{
+    QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+    GLuint texture = 0;
+    gl->glGenTextures(1, &texture);
+    state.activeTexture(GL_TEXTURE0);
+    state.bindTexture(GL_TEXTURE_2D, texture);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    return texture;
+}
+
+void TextureStreamer::deleteTexture(GLuint texture)
+{
+    if (texture == 0)
+        return;
+    QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &texture);
+}
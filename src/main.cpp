@@ -1,11 +1,131 @@
 #include "MainWindow.h"
+#include "BatchRenderer.h"
+#include "LoadGenerator.h"
+#include "SceneProtocol.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QThread>
+
+#include <cstring>
+
+// Looks for "--name" or "--name=value" before there is an application to parse the arguments
+static bool hasOption(int argc, char *argv[], const char *name)
+{
+    const size_t length = std::strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], name, length) == 0 && (argv[i][length] == '\0' || argv[i][length] == '=')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Headless image export: renders generated scenes to PNG files and exits
+static int runBatch(int argc, char *argv[])
+{
+    // Parallelism comes from one context per worker, keep llvmpipe from starting a rasterizer pool for each of them
+    if (!qEnvironmentVariableIsSet("LP_NUM_THREADS")) {
+        qputenv("LP_NUM_THREADS", "1");
+    }
+    QGuiApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders random scenes to PNG files without a window.");
+    parser.addHelpOption();
+    const QCommandLineOption renderOption("render", "Render into <directory> and exit.", "directory");
+    const QCommandLineOption scenesOption("scenes", "Number of scenes to render.", "count", "16");
+    const QCommandLineOption shapesOption("shapes", "Cubes per scene.", "count", "100");
+    const QCommandLineOption sizeOption("size", "Image size, may exceed the maximum framebuffer size.", "WxH", "1920x1080");
+    const QCommandLineOption tileOption("tile", "Largest tile edge in pixels, 0 for the driver maximum.", "pixels", "0");
+    const QCommandLineOption threadsOption("threads", "Render threads.", "count", QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption staticBatchingOption("static-batching", "Merge the cubes of a scene into static chunks.");
+    parser.addOptions({ renderOption, scenesOption, shapesOption, sizeOption, tileOption, threadsOption, staticBatchingOption });
+    parser.process(a);
+
+    BatchOptions options;
+    options.OutputDir = parser.value(renderOption);
+    options.SceneCount = parser.value(scenesOption).toInt();
+    options.ShapesPerScene = parser.value(shapesOption).toInt();
+    options.TileSize = parser.value(tileOption).toInt();
+    options.Threads = parser.value(threadsOption).toInt();
+    options.StaticBatching = parser.isSet(staticBatchingOption);
+    const QStringList size = parser.value(sizeOption).split('x');
+    if (size.size() == 2) {
+        options.ImageSize = QSize(size[0].toInt(), size[1].toInt());
+    }
+    if (options.OutputDir.isEmpty() || options.ImageSize.isEmpty() || options.SceneCount < 0 || options.ShapesPerScene < 0 ||
+        options.TileSize < 0 || options.Threads < 1) {
+        parser.showHelp(1);
+    }
+
+    BatchRenderer renderer(options);
+    return renderer.run() ? 0 : 1;
+}
+
+// Streams transform updates into a running viewer and reports the latency
+static int runLoadTest(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Streams transform updates into a running viewer over its command socket.");
+    parser.addHelpOption();
+    const QCommandLineOption loadTestOption("load-test", "Run the load generator and exit.");
+    const QCommandLineOption serverOption("server", "Command socket of the viewer.", "name", SceneProtocol::DefaultServerName);
+    const QCommandLineOption shapesOption("shapes", "Cubes to create and move.", "count", "10000");
+    const QCommandLineOption rateOption("rate", "Transform updates per second.", "count", "200000");
+    const QCommandLineOption batchOption("batch", "Transform updates per message.", "count", "1000");
+    const QCommandLineOption secondsOption("seconds", "Length of the run.", "seconds", "10");
+    parser.addOptions({ loadTestOption, serverOption, shapesOption, rateOption, batchOption, secondsOption });
+    parser.process(a);
+
+    LoadOptions options;
+    options.ServerName = parser.value(serverOption);
+    options.Shapes = parser.value(shapesOption).toInt();
+    options.UpdatesPerSecond = parser.value(rateOption).toInt();
+    options.BatchSize = parser.value(batchOption).toInt();
+    options.Seconds = parser.value(secondsOption).toInt();
+    if (options.Shapes < 1 || options.UpdatesPerSecond < 1 || options.BatchSize < 1 || options.Seconds < 1) {
+        parser.showHelp(1);
+    }
+
+    LoadGenerator generator(options);
+    return generator.run() ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    if (hasOption(argc, argv, "--render")) {
+        return runBatch(argc, argv);
+    }
+    if (hasOption(argc, argv, "--load-test")) {
+        return runLoadTest(argc, argv);
+    }
+
+    // All views share one set of shaders, buffers and textures
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption budgetOption("frame-budget", "Frame time the views together should stay within.", "ms", "16.6");
+    const QCommandLineOption dynamicResolutionOption("dynamic-resolution", "Lower the render resolution to hold the frame budget.");
+    const QCommandLineOption staticBatchingOption("static-batching", "Draw cubes that never move as a few merged chunks.");
+    parser.addOptions({ budgetOption, dynamicResolutionOption, staticBatchingOption });
+    parser.process(a);
+    bool budgetValid = false;
+    const float budget = parser.value(budgetOption).toFloat(&budgetValid);
+    if (!budgetValid || budget <= 0.0f) {
+        parser.showHelp(1);
+    }
+
     MainWindow w;
+    w.setFrameBudget(budget);
+    w.setDynamicResolution(parser.isSet(dynamicResolutionOption));
+    w.setStaticBatching(parser.isSet(staticBatchingOption));
     w.show();
     return a.exec();
 }